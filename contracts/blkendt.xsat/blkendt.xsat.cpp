@@ -28,6 +28,34 @@ void block_endorse::erase(const uint64_t height) {
     while (xsat_endorsement_itr != _xsat_endorsement.end()) {
         xsat_endorsement_itr = _xsat_endorsement.erase(xsat_endorsement_itr);
     }
+
+    // eligible snapshots are no longer referenced once the highest height using them is erased, final rows copied
+    // by `migrate_endorsements` keep their own validator lists
+    auto validator_set_info_idx = _validator_set_info.get_index<"bylastheight"_n>();
+    auto validator_set_info_itr = validator_set_info_idx.begin();
+    while (validator_set_info_itr != validator_set_info_idx.end() && validator_set_info_itr->last_height <= height) {
+        validator_set_info_itr = validator_set_info_idx.erase(validator_set_info_itr);
+    }
+}
+
+//@auth utxomng.xsat
+[[eosio::action]]
+void block_endorse::erasefork(const uint64_t height, const checksum256& hash) {
+    require_auth(UTXO_MANAGE_CONTRACT);
+
+    block_endorse::endorsement_table _endorsement(get_self(), height);
+    auto endorsement_idx = _endorsement.get_index<"byhash"_n>();
+    auto endorsement_itr = endorsement_idx.find(hash);
+    if (endorsement_itr != endorsement_idx.end()) {
+        endorsement_idx.erase(endorsement_itr);
+    }
+
+    block_endorse::endorsement_table _xsat_endorsement(get_self(), height | XSAT_SCOPE_MASK);
+    auto xsat_endorsement_idx = _xsat_endorsement.get_index<"byhash"_n>();
+    auto xsat_endorsement_itr = xsat_endorsement_idx.find(hash);
+    if (xsat_endorsement_itr != xsat_endorsement_idx.end()) {
+        xsat_endorsement_idx.erase(xsat_endorsement_itr);
+    }
 }
 
 //@auth get_self()
@@ -72,6 +100,23 @@ void block_endorse::setqualify(const asset& min_xsat_qualification, const asset&
     _config.set(config, get_self());
 }
 
+//@auth get_self()
+[[eosio::action]]
+void block_endorse::setcommittee(const uint16_t committee_size) {
+    require_auth(get_self());
+
+    auto config = _config.get();
+    check(committee_size == 0 || committee_size >= config.min_validators,
+          "blkendt.xsat::setcommittee: committee_size must be 0 or greater than or equal to min_validators");
+
+    // earlier extensions are set to their effective values so that committee_size can be serialized
+    config.min_btc_qualification = config.get_btc_base_stake();
+    config.xsat_reward_height = config.xsat_reward_height.value_or(0);
+    config.validator_active_vote_count = config.get_validator_active_vote_count();
+    config.committee_size = committee_size;
+    _config.set(config, get_self());
+}
+
 //@auth get_self()
 [[eosio::action]]
 void block_endorse::setconheight(const uint64_t xsat_stake_activation_height, const uint64_t xsat_reward_height) {
@@ -92,15 +137,128 @@ void block_endorse::setconheight(const uint64_t xsat_stake_activation_height, co
 void block_endorse::endorse(const name& validator, const uint64_t height, const checksum256& hash) {
     require_auth(validator);
 
-    // Verify whether the endorsement height exceeds limit_endorse_height, 0 means no limit
     auto config = _config.get();
-    check(config.limit_endorse_height == 0 || config.limit_endorse_height >= height,
-          "1001:blkendt.xsat::endorse: the current endorsement status is disabled");
+    utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    auto chain_state = _chain_state.get();
+    check_endorse_height(config, chain_state, height);
+
+    // fee deduction
+    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
+    pay.send(height, hash, validator, ENDORSE, 1);
+
+    // v2 check validator
+    endorse_manage::validator_table _validator
+        = endorse_manage::validator_table(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+    auto validator_itr = _validator.require_find(validator.value, "blkendt.xsat::endorse: [validators] does not exists");
+    auto vote_activity = endorse_manage::get_vote_activity(*validator_itr);
+
+    auto result = endorse_block(config, chain_state, *validator_itr, vote_activity, height, hash);
+    if (result.record_vote) {
+        // send endrmng.xsat::endorse
+        endorse_manage::endorse_action _endorse(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
+        _endorse.send(validator, height);
+    }
+    dispatch_consensus(config, result, height, hash);
+}
+
+//@auth validator
+[[eosio::action]]
+void block_endorse::endorses(const name& validator, const uint64_t start_height, const std::vector<checksum256>& hashes) {
+    require_auth(validator);
+    check(!hashes.empty() && hashes.size() <= MAX_ENDORSE_HEIGHTS_PER_ACTION,
+          "1010:blkendt.xsat::endorses: the number of hashes must be between 1 and "
+              + std::to_string(MAX_ENDORSE_HEIGHTS_PER_ACTION));
 
+    auto config = _config.get();
     utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    auto chain_state = _chain_state.get();
+    const auto end_height = start_height + hashes.size() - 1;
+    for (auto height = start_height; height <= end_height; height++) {
+        check_endorse_height(config, chain_state, height);
+    }
 
-    // Blocks that are already irreversible do not need to be endorsed
+    // one fee deduction for all heights
+    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
+    pay.send(end_height, hashes.back(), validator, ENDORSE, hashes.size());
+
+    endorse_manage::validator_table _validator
+        = endorse_manage::validator_table(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+    auto validator_itr = _validator.require_find(validator.value, "blkendt.xsat::endorses: [validators] does not exists");
+    auto vote_activity = endorse_manage::get_vote_activity(*validator_itr);
+
+    // the heights recorded by endrmng.xsat in a single bookkeeping update
+    std::vector<uint64_t> heights;
+    for (uint64_t i = 0; i < hashes.size(); i++) {
+        const auto height = start_height + i;
+        auto result = endorse_block(config, chain_state, *validator_itr, vote_activity, height, hashes[i]);
+        if (result.record_vote) {
+            heights.push_back(height);
+            // same counting as endrmng.xsat::endorses
+            bool is_consecutive
+                = vote_activity.latest_consensus_block > 0 && height == vote_activity.latest_consensus_block + 1;
+            vote_activity.consecutive_vote_count = is_consecutive ? vote_activity.consecutive_vote_count + 1ULL : 1ULL;
+            vote_activity.latest_consensus_block = height;
+        }
+        dispatch_consensus(config, result, height, hashes[i]);
+    }
+
+    if (!heights.empty()) {
+        endorse_manage::endorses_action _endorses(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
+        _endorses.send(validator, heights);
+    }
+}
+
+//@auth validators
+[[eosio::action]]
+void block_endorse::endorsebatch(const uint64_t height, const checksum256& hash, const std::vector<name>& validators) {
+    check(!validators.empty(), "1011:blkendt.xsat::endorsebatch: validators cannot be empty");
+    for (const auto& validator : validators) {
+        require_auth(validator);
+    }
+
+    auto config = _config.get();
+    utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
     auto chain_state = _chain_state.get();
+    check_endorse_height(config, chain_state, height);
+
+    endorse_manage::validator_table _validator
+        = endorse_manage::validator_table(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
+    endorse_manage::endorse_action _endorse(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
+
+    // each validator signs the bundle, the quorum of both scopes is evaluated once after all votes are counted
+    optional<utxo_manage::endorsement_quorum> btc_quorum;
+    optional<utxo_manage::endorsement_quorum> xsat_quorum;
+    for (const auto& validator : validators) {
+        // fee deduction
+        pay.send(height, hash, validator, ENDORSE, 1);
+
+        auto validator_itr = _validator.require_find(validator.value, "blkendt.xsat::endorsebatch: [validators] does not exists");
+        auto vote_activity = endorse_manage::get_vote_activity(*validator_itr);
+
+        auto result = endorse_block(config, chain_state, *validator_itr, vote_activity, height, hash);
+        if (result.record_vote) {
+            _endorse.send(validator, height);
+        }
+        if (result.quorum.has_value()) {
+            if (result.xsat_validator) {
+                xsat_quorum = result.quorum;
+            } else {
+                btc_quorum = result.quorum;
+            }
+        }
+    }
+
+    dispatch_consensus(config, btc_quorum, xsat_quorum, height, hash);
+}
+
+void block_endorse::check_endorse_height(const config_row& config, const utxo_manage::chain_state_row& chain_state,
+                                         const uint64_t height) {
+    // Verify whether the endorsement height exceeds limit_endorse_height, 0 means no limit
+    check(config.limit_endorse_height == 0 || config.limit_endorse_height >= height,
+          "1001:blkendt.xsat::endorse: the current endorsement status is disabled");
+
+    // Blocks that are already irreversible do not need to be endorsed
     check(chain_state.irreversible_height < height && chain_state.migrating_height != height,
           "1002:blkendt.xsat::endorse: the current block is irreversible and does not need to be endorsed");
 
@@ -109,15 +267,64 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
         config.limit_num_endorsed_blocks == 0 || chain_state.parsed_height + config.limit_num_endorsed_blocks >= height,
         "1003:blkendt.xsat::endorse: the endorsement height cannot exceed height "
             + std::to_string(chain_state.parsed_height + config.limit_num_endorsed_blocks));
+}
 
-    // fee deduction
-    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
-    pay.send(height, hash, validator, ENDORSE, 1);
+void block_endorse::dispatch_consensus(const config_row& config, optional<utxo_manage::endorsement_quorum> btc_quorum,
+                                       optional<utxo_manage::endorsement_quorum> xsat_quorum, const uint64_t height,
+                                       const checksum256& hash) {
+    if (!btc_quorum.has_value() && !xsat_quorum.has_value()) {
+        return;
+    }
 
-    // v2 check validator
-    endorse_manage::validator_table _validator
-        = endorse_manage::validator_table(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
-    auto validator_itr = _validator.require_find(validator.value, "blkendt.xsat::endorse: [validators] does not exists");
+    // timeline
+    utxo_manage::recordstage_action _recordstage(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+    if (btc_quorum.has_value()) {
+        _recordstage.send(height, hash, utxo_manage::stage_btc_quorum);
+    }
+    if (xsat_quorum.has_value()) {
+        _recordstage.send(height, hash, utxo_manage::stage_xsat_quorum);
+    }
+
+    // For consensus version 2 with XSAT consensus enabled, the BTC and XSAT endorsements must both reach consensus,
+    // otherwise only the BTC endorsement is required. The scope not endorsed in this action is read from its record.
+    const auto xsat_consensus_active = config.is_xsat_consensus_active(height);
+    if (!btc_quorum.has_value()) {
+        btc_quorum = get_reached_quorum(height, hash);
+    } else if (xsat_consensus_active && !xsat_quorum.has_value()) {
+        xsat_quorum = get_reached_quorum(height | XSAT_SCOPE_MASK, hash);
+    }
+    if (!btc_quorum.has_value() || (xsat_consensus_active && !xsat_quorum.has_value())) {
+        return;
+    }
+
+    // If consensus conditions are met, hand the quorum over so that utxomng.xsat does not evaluate it again.
+    utxo_manage::quorum_proof proof{.btc = *btc_quorum};
+    if (xsat_consensus_active) {
+        proof.xsat = xsat_quorum;
+    }
+    utxo_manage::qconsensus_action qconsensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+    qconsensus.send(height, hash, proof);
+}
+
+void block_endorse::dispatch_consensus(const config_row& config, const endorse_result& result, const uint64_t height,
+                                       const checksum256& hash) {
+    if (!result.quorum.has_value()) {
+        return;
+    }
+    if (result.xsat_validator) {
+        dispatch_consensus(config, std::nullopt, result.quorum, height, hash);
+    } else {
+        dispatch_consensus(config, result.quorum, std::nullopt, height, hash);
+    }
+}
+
+block_endorse::endorse_result block_endorse::endorse_block(const config_row& config,
+                                                            const utxo_manage::chain_state_row& chain_state,
+                                                            const endorse_manage::validator_row& validator_row,
+                                                            const endorse_manage::vote_activity_row& vote_activity,
+                                                            const uint64_t height, const checksum256& hash) {
+    const auto validator = validator_row.owner;
+    const auto latest_consensus_block = vote_activity.latest_consensus_block;
 
     auto validator_active_vote_count = config.get_validator_active_vote_count();
     
@@ -133,39 +340,76 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
 
     // get endorsement scope
     bool xsat_validator = false;
-    if (validator_itr->role.has_value() && validator_itr->role.value() == 1) {
+    if (validator_row.role.has_value() && validator_row.role.value() == 1) {
         xsat_validator = true;
     }
 
-    auto _endorse_scope = height;
-    auto _other_endorse_scope = height | XSAT_SCOPE_MASK;
-
-    if (xsat_validator) {
-
-        _endorse_scope = height | XSAT_SCOPE_MASK;
-        _other_endorse_scope = height;
-    }
+    auto _endorse_scope = xsat_validator ? height | XSAT_SCOPE_MASK : height;
+    // the same height switches as the validator scans below
+    auto check_active = xsat_validator ? config.is_xsat_reward_active(height) : config.is_xsat_consensus_active(height);
 
     block_endorse::endorsement_table _endorsement(get_self(), _endorse_scope);
     auto endorsement_idx = _endorsement.get_index<"byhash"_n>();
     auto endorsement_itr = endorsement_idx.find(hash);
-    bool reached_consensus = false;
-    bool is_send_endorse = !is_revote;
+    // set when the endorsement of the validator's scope reached consensus
+    optional<utxo_manage::endorsement_quorum> quorum;
 
     // check validator is requested
+    // Endorsements created from an eligible validator snapshot record votes as bitmaps over the validator set,
+    // the others keep the requested and provider validator lists
     std::vector<requested_validator_info> requested_validators;
+    optional<endorse_manage::eligible_snapshot_row> snapshot;
+    optional<endorsement_votes> votes;
+    bool is_committee = false;
     if (endorsement_itr != endorsement_idx.end()) {
-        requested_validators = endorsement_itr->requested_validators;
+        if (endorsement_itr->votes.has_value()) {
+            votes = endorsement_itr->votes.value();
+        } else {
+            requested_validators = endorsement_itr->requested_validators;
+        }
+    } else {
+        snapshot = get_eligible_snapshot(config, xsat_validator);
+        if (snapshot.has_value()) {
+            votes = get_requested_votes(*snapshot, check_active, height, validator_active_vote_count, vote_activity);
+
+            // committee mode, quorum is computed over a stake-weighted sample of the requested validators
+            auto committee_size = config.get_committee_size();
+            if (committee_size > 0 && votes->num_validators > committee_size) {
+                sample_committee(*votes, *snapshot, hash, committee_size);
+                is_committee = true;
+            }
+        } else {
+            requested_validators = xsat_validator ? get_valid_validator_by_xsat_stake(height, validator_active_vote_count)
+                                        : get_valid_validator_by_btc_stake(height, validator_active_vote_count);
+        }
+    }
 
-    }else{
-        requested_validators = xsat_validator ? get_valid_validator_by_xsat_stake(height, validator_active_vote_count)
-                                    : get_valid_validator_by_btc_stake(height, validator_active_vote_count);
+    // position of the validator in the eligible snapshot of the vote bitmaps
+    optional<snapshot_member> member;
+    if (votes.has_value()) {
+        if (!snapshot.has_value()) {
+            snapshot = endorse_manage::find_eligible_snapshot(votes->validator_set_id);
+            check(snapshot.has_value(), "blkendt.xsat::endorse: [eligibles] does not exists");
+        }
+        auto itr = std::lower_bound(snapshot->validators.begin(), snapshot->validators.end(), validator,
+                                    [](const endorse_manage::eligible_validator& a, const name& b) {
+                                        return a.account < b;
+                                    });
+        if (itr != snapshot->validators.end() && itr->account == validator) {
+            member = snapshot_member{.index = static_cast<uint16_t>(itr - snapshot->validators.begin()),
+                                     .staking = itr->staking};
+        }
     }
-    auto is_requested = std::any_of(requested_validators.begin(), requested_validators.end(), [&](const requested_validator_info& a) {
-        return a.account == validator;
-    });
-    
-    auto latest_consensus_block = validator_itr->latest_consensus_block.has_value() ? validator_itr->latest_consensus_block.value() : uint64_t(0);
+
+    bool is_requested = false;
+    if (votes.has_value()) {
+        is_requested = member.has_value() && votes->is_requested(member->index) && !votes->is_provided(member->index);
+    } else {
+        is_requested = std::any_of(requested_validators.begin(), requested_validators.end(), [&](const requested_validator_info& a) {
+            return a.account == validator;
+        });
+    }
+
     // Not in request list
     if (!is_requested && 
         // XSAT reward active
@@ -175,13 +419,11 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
         // latest consensus block is not the current block
         height > latest_consensus_block) { 
                 
-        check(validator_itr->active_flag.has_value() && validator_itr->active_flag.value() == 1, "1007:blkendt.xsat::endorse: validator is not active");
+        check(validator_row.active_flag.has_value() && validator_row.active_flag.value() == 1, "1007:blkendt.xsat::endorse: validator is not active");
         check(chain_state.head_height - height  <= (validator_active_vote_count - 1), "1009:blkendt.xsat::endorse: endorse height must be within the last validator_active_vote_count blocks from current head height");
 
-        // send endrmng.xsat::endorse           
-        endorse_manage::endorse_action _endorse(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
-        _endorse.send(validator, height);
-        return;
+        // record the vote in endrmng.xsat
+        return {.record_vote = true, .quorum = quorum, .xsat_validator = xsat_validator};
     }
 
     auto err_msg = "1005:blkendt.xsat::endorse: validator not in requested_validators list";
@@ -204,7 +446,7 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
         // check xsat consensus active
         if (config.is_xsat_consensus_active(height)) {
 
-            check(validator_itr->active_flag.has_value() && validator_itr->active_flag.value() == 1, "1007:blkendt.xsat::endorse: validator is not active");
+            check(validator_row.active_flag.has_value() && validator_row.active_flag.value() == 1, "1007:blkendt.xsat::endorse: validator is not active");
         }
 
         // Obtain qualified validators based on the pledge amount.
@@ -213,25 +455,61 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
         //     = xsat_validator ? get_valid_validator_by_xsat_stake(height, validator_active_vote_count)
         //                         : get_valid_validator_by_btc_stake(height, validator_active_vote_count);
 
-        check(requested_validators.size() >= config.min_validators,
+        auto num_validators = votes.has_value() ? votes->num_validators : requested_validators.size();
+        check(num_validators >= config.min_validators,
               "1004:blkendt.xsat::endorse: the number of valid validators must be greater than or equal to "
                   + std::to_string(config.min_validators));
 
-        auto itr = std::find_if(requested_validators.begin(), requested_validators.end(),
-                                [&](const requested_validator_info& a) {
-                                    return a.account == validator;
-                                });
-        check(itr != requested_validators.end(), err_msg);
-        provider_validator_info provider_info{
-            .account = itr->account, .staking = itr->staking, .created_at = current_time_point()};
-        requested_validators.erase(itr);
-        auto endt_itr = _endorsement.emplace(get_self(), [&](auto& row) {
-            row.id = _endorsement.available_primary_key();
-            row.hash = hash;
-            row.provider_validators.push_back(provider_info);
-            row.requested_validators = requested_validators;
+        if (votes.has_value()) {
+            // a validator outside the committee may still open the record, its vote is then only recorded by endrmng.xsat
+            check(is_requested || (is_committee && member.has_value()), err_msg);
+            save_validator_set(*snapshot, height);
+            if (is_requested) {
+                votes->provide(member->index, member->staking);
+            }
+            auto endt_itr = _endorsement.emplace(get_self(), [&](auto& row) {
+                row.id = _endorsement.available_primary_key();
+                row.hash = hash;
+                row.votes = *votes;
+            });
+            if (endt_itr->reached_consensus()) {
+                quorum = get_quorum(*endt_itr);
+            }
+        } else {
+            auto itr = std::find_if(requested_validators.begin(), requested_validators.end(),
+                                    [&](const requested_validator_info& a) {
+                                        return a.account == validator;
+                                    });
+            check(itr != requested_validators.end(), err_msg);
+            provider_validator_info provider_info{
+                .account = itr->account, .staking = itr->staking, .created_at = current_time_point()};
+            requested_validators.erase(itr);
+            auto endt_itr = _endorsement.emplace(get_self(), [&](auto& row) {
+                row.id = _endorsement.available_primary_key();
+                row.hash = hash;
+                row.provider_validators.push_back(provider_info);
+                row.requested_validators = requested_validators;
+            });
+            if (endt_itr->num_reached_consensus() <= endt_itr->provider_validators.size()) {
+                quorum = get_quorum(*endt_itr);
+            }
+        }
+    } else if (votes.has_value()) {
+        check(!member.has_value() || !votes->is_provided(member->index),
+              "1006:blkendt.xsat::endorse: validator is on the list of provider validators");
+
+        // if validator not in requested validators, only record the vote in endrmng.xsat
+        if (!is_requested) {
+            return {.record_vote = true, .quorum = quorum, .xsat_validator = xsat_validator};
+        }
+
+        votes->provide(member->index, member->staking);
+        endorsement_idx.modify(endorsement_itr, same_payer, [&](auto& row) {
+            row.votes = *votes;
         });
-        reached_consensus = endt_itr->num_reached_consensus() <= endt_itr->provider_validators.size();
+        if (endorsement_itr->reached_consensus()) {
+            quorum = get_quorum(*endorsement_itr);
+        }
     } else {
         check(std::find_if(endorsement_itr->provider_validators.begin(), endorsement_itr->provider_validators.end(),
                            [&](const provider_validator_info& a) {
@@ -244,12 +522,9 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
                                 endorsement_itr->requested_validators.end(), [&](const requested_validator_info& a) {
                                     return a.account == validator;
                                 });
-        // if validator not in requested_validators list, send endrmng.xsat::endorse
+        // if validator not in requested_validators list, only record the vote in endrmng.xsat
         if (itr == endorsement_itr->requested_validators.end()) {
-            // send endrmng.xsat::endorse
-            endorse_manage::endorse_action _endorse(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
-            _endorse.send(validator, height);
-            return;
+            return {.record_vote = true};
         }
 
         endorsement_idx.modify(endorsement_itr, same_payer, [&](auto& row) {
@@ -257,43 +532,51 @@ void block_endorse::endorse(const name& validator, const uint64_t height, const
                 {.account = itr->account, .staking = itr->staking, .created_at = current_time_point()});
             row.requested_validators.erase(itr);
         });
-        reached_consensus = endorsement_itr->num_reached_consensus() <= endorsement_itr->provider_validators.size();
+        if (endorsement_itr->num_reached_consensus() <= endorsement_itr->provider_validators.size()) {
+            quorum = get_quorum(*endorsement_itr);
+        }
     }
-    
+
     // if validator endorse a new block or in the requested_validators list
-    // Even the validator latest consensus block is greater than current height, don't send endorse
-    if (validator_itr->latest_consensus_block.has_value() && validator_itr->latest_consensus_block.value() >= height) {
-        is_send_endorse = false;
-    }
-    
-    if (is_send_endorse) {
-        // send endrmng.xsat::endorse
-        endorse_manage::endorse_action _endorse(ENDORSER_MANAGE_CONTRACT, {get_self(), "active"_n});
-        _endorse.send(validator, height);
+    // Even the validator latest consensus block is greater than current height, don't record the vote
+    return {.record_vote = !is_revote && latest_consensus_block < height,
+            .quorum = quorum,
+            .xsat_validator = xsat_validator};
+}
+
+optional<utxo_manage::endorsement_quorum> block_endorse::get_reached_quorum(const uint64_t scope, const checksum256& hash) {
+    block_endorse::endorsement_table _endorsement(get_self(), scope);
+    auto endorsement_idx = _endorsement.get_index<"byhash"_n>();
+    auto endorsement_itr = endorsement_idx.find(hash);
+    if (endorsement_itr == endorsement_idx.end() || !endorsement_itr->reached_consensus()) {
+        return std::nullopt;
     }
+    return get_quorum(*endorsement_itr);
+}
 
-    if (reached_consensus) {
-        // For consensus version 2 with XSAT consensus enabled, verify that the XSAT endorsement result
-        // is consistent with the BTC endorsement result.
-        if (config.is_xsat_consensus_active(height)) {
-            // Retrieve the endorsement record from the XSAT consensus scope.
-            block_endorse::endorsement_table other_endorsement(get_self(), _other_endorse_scope);
-            auto other_endorsement_idx = other_endorsement.get_index<"byhash"_n>();
-            auto other_endorsement_itr = other_endorsement_idx.find(hash);
-
-            // If the XSAT endorsement record does not exist, or its number of reached consensus validators
-            // exceeds the number of provider validators from the BTC endorsement, then do not proceed.
-            if (other_endorsement_itr == other_endorsement_idx.end() ||
-                other_endorsement_itr->num_reached_consensus() > other_endorsement_itr->provider_validators.size()) {
-                
-                return;
-            }
-        }
+utxo_manage::endorsement_quorum block_endorse::get_quorum(const endorsement_row& endorsement) {
+    if (endorsement.votes.has_value()) {
+        const auto& votes = endorsement.votes.value();
+        return {.validator_set_id = votes.validator_set_id,
+                .num_validators = votes.num_validators,
+                .num_providers = votes.num_providers,
+                .total_staking = votes.total_staking,
+                .provided_staking = votes.provided_staking};
+    }
 
-        // If consensus conditions are met, trigger the consensus action.
-        utxo_manage::consensus_action consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
-        consensus.send(height, hash);
+    uint64_t provided_staking = 0;
+    for (const auto& provider : endorsement.provider_validators) {
+        provided_staking += provider.staking;
     }
+    uint64_t total_staking = provided_staking;
+    for (const auto& requested : endorsement.requested_validators) {
+        total_staking += requested.staking;
+    }
+    return {.validator_set_id = 0,
+            .num_validators = static_cast<uint16_t>(endorsement.num_validators()),
+            .num_providers = static_cast<uint16_t>(endorsement.num_providers()),
+            .total_staking = total_staking,
+            .provided_staking = provided_staking};
 }
 
 std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_validator_by_btc_stake(const uint64_t height, const uint8_t consecutive_vote_count) {
@@ -328,14 +611,14 @@ std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_va
             if (consecutive_vote_count > 0) {
                 // if latest endorse block is not the current block, that mean the validator is not endorse previous block
                 // so it not consecutive endorse 
-                auto latest_consensus_block = itr->latest_consensus_block.has_value() ? itr->latest_consensus_block.value() : uint64_t(0);
-                if (height > latest_consensus_block + 1) {
+                auto vote_activity = endorse_manage::get_vote_activity(*itr);
+                if (height > vote_activity.latest_consensus_block + 1) {
 
                     itr++;
                     continue;
                 }
 
-                if (itr->consecutive_vote_count.value() < consecutive_vote_count) {
+                if (vote_activity.consecutive_vote_count < consecutive_vote_count) {
 
                     itr++;
                     continue;
@@ -380,14 +663,14 @@ std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_va
             if (consecutive_vote_count > 0) {
                  // if latest endorse block is not the current block, that mean the validator is not endorse previous block
                 // so it not consecutive endorse 
-                auto latest_consensus_block = itr->latest_consensus_block.has_value() ? itr->latest_consensus_block.value() : uint64_t(0);
-                if (height > latest_consensus_block + 1) {
+                auto vote_activity = endorse_manage::get_vote_activity(*itr);
+                if (height > vote_activity.latest_consensus_block + 1) {
 
                     itr++;
                     continue;
                 }
 
-                if (itr->consecutive_vote_count.value() < consecutive_vote_count) {
+                if (vote_activity.consecutive_vote_count < consecutive_vote_count) {
 
                     itr++;
                     continue;
@@ -402,6 +685,142 @@ std::vector<block_endorse::requested_validator_info> block_endorse::get_valid_va
     return result;
 }
 
+// The snapshot maintained by endrmng.xsat is only used if it was built with the current qualification
+optional<endorse_manage::eligible_snapshot_row> block_endorse::get_eligible_snapshot(const config_row& config,
+                                                                                     const bool xsat_validator) {
+    auto snapshot = endorse_manage::get_eligible_snapshot(xsat_validator ? 1 : 0);
+    auto min_qualification
+        = xsat_validator ? config.min_xsat_qualification.amount : config.get_btc_base_stake().amount;
+    if (!snapshot.has_value() || snapshot->min_qualification != min_qualification) {
+        return std::nullopt;
+    }
+    return snapshot;
+}
+
+// Vote counters change every block and are not part of the snapshot, they are read when the request is built with the
+// same rule as the validator scans. The endorser's counters are taken from the action, endorsebatch has not saved them yet.
+block_endorse::endorsement_votes block_endorse::get_requested_votes(
+    const endorse_manage::eligible_snapshot_row& snapshot, const bool check_active, const uint64_t height,
+    const uint8_t consecutive_vote_count, const endorse_manage::vote_activity_row& endorser_activity) {
+    endorsement_votes votes{.validator_set_id = snapshot.id};
+    votes.requested.resize((snapshot.validators.size() + 7) / 8);
+    votes.provided.resize(votes.requested.size());
+
+    endorse_manage::validator_table _validator
+        = endorse_manage::validator_table(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+    for (uint16_t index = 0; index < snapshot.validators.size(); index++) {
+        const auto& validator = snapshot.validators[index];
+        if (check_active && validator.active_flag == 0) {
+            continue;
+        }
+
+        if (check_active && consecutive_vote_count > 0) {
+            auto vote_activity = endorser_activity;
+            if (validator.account != endorser_activity.validator) {
+                auto validator_itr = _validator.find(validator.account.value);
+                if (validator_itr == _validator.end()) {
+                    continue;
+                }
+                vote_activity = endorse_manage::get_vote_activity(*validator_itr);
+            }
+            if (height > vote_activity.latest_consensus_block + 1
+                || vote_activity.consecutive_vote_count < consecutive_vote_count) {
+                continue;
+            }
+        }
+
+        votes.requested[index / 8] |= 1 << (index % 8);
+        votes.num_validators++;
+        votes.total_staking += validator.staking;
+    }
+    return votes;
+}
+
+// Stake-weighted sampling without replacement over the requested validators. The draws are seeded by the block hash
+// and the validator set id, so every endorser of the same block derives the same committee.
+void block_endorse::sample_committee(endorsement_votes& votes, const endorse_manage::eligible_snapshot_row& snapshot,
+                                     const checksum256& hash, const uint16_t committee_size) {
+    std::vector<uint16_t> candidates;
+    candidates.reserve(votes.num_validators);
+    for (uint16_t index = 0; index < snapshot.validators.size(); index++) {
+        if (votes.is_requested(index)) {
+            candidates.push_back(index);
+        }
+    }
+
+    // fenwick tree over the staking of the candidates, a drawn candidate has its staking removed
+    const auto num_candidates = candidates.size();
+    std::vector<uint64_t> tree(num_candidates + 1, 0);
+    uint64_t remaining_staking = 0;
+    for (size_t i = 1; i <= num_candidates; i++) {
+        const auto staking = snapshot.validators[candidates[i - 1]].staking;
+        remaining_staking += staking;
+        tree[i] += staking;
+        const auto parent = i + (i & (~i + 1));
+        if (parent <= num_candidates) {
+            tree[parent] += tree[i];
+        }
+    }
+    size_t top_step = 1;
+    while (top_step * 2 <= num_candidates) {
+        top_step *= 2;
+    }
+
+    std::array<uint8_t, 44> seed;
+    const auto hash_bytes = hash.extract_as_byte_array();
+    std::copy(hash_bytes.begin(), hash_bytes.end(), seed.begin());
+    std::memcpy(seed.data() + 32, &snapshot.id, sizeof(uint64_t));
+
+    endorsement_votes committee{.validator_set_id = votes.validator_set_id};
+    committee.requested.resize(votes.requested.size());
+    committee.provided.resize(votes.requested.size());
+    for (uint32_t draw = 0; draw < committee_size && remaining_staking > 0; draw++) {
+        std::memcpy(seed.data() + 40, &draw, sizeof(uint32_t));
+        const auto digest = eosio::sha256(reinterpret_cast<const char*>(seed.data()), seed.size()).extract_as_byte_array();
+        uint64_t target;
+        std::memcpy(&target, digest.data(), sizeof(uint64_t));
+        target %= remaining_staking;
+
+        // the first candidate whose cumulative staking exceeds target
+        size_t pos = 0;
+        for (auto step = top_step; step > 0; step >>= 1) {
+            if (pos + step <= num_candidates && tree[pos + step] <= target) {
+                pos += step;
+                target -= tree[pos];
+            }
+        }
+
+        const auto index = candidates[pos];
+        const auto staking = snapshot.validators[index].staking;
+        committee.requested[index / 8] |= 1 << (index % 8);
+        committee.num_validators++;
+        committee.total_staking += staking;
+        remaining_staking -= staking;
+        for (auto i = pos + 1; i <= num_candidates; i += i & (~i + 1)) {
+            tree[i] -= staking;
+        }
+    }
+    votes = committee;
+}
+
+// The snapshot itself stays in endrmng.xsat, which keeps it unchanged while it is referenced here
+void block_endorse::save_validator_set(const endorse_manage::eligible_snapshot_row& snapshot, const uint64_t height) {
+    auto validator_set_info_itr = _validator_set_info.find(snapshot.id);
+    if (validator_set_info_itr != _validator_set_info.end()) {
+        if (validator_set_info_itr->last_height < height) {
+            _validator_set_info.modify(validator_set_info_itr, same_payer, [&](auto& row) {
+                row.last_height = height;
+            });
+        }
+        return;
+    }
+    _validator_set_info.emplace(get_self(), [&](auto& row) {
+        row.id = snapshot.id;
+        row.num_validators = snapshot.validators.size();
+        row.last_height = height;
+    });
+}
+
 [[eosio::action]]
 void block_endorse::revote(const name& synchronizer, const uint64_t height) {
     require_auth(synchronizer);
@@ -431,16 +850,20 @@ void block_endorse::revote(const name& synchronizer, const uint64_t height) {
     });
 
     // calculate required votes
-    // filter active synchronizers
-    std::vector<name> active_synchronizers;
-    for(auto sync_itr = _synchronizer.begin(); sync_itr != _synchronizer.end(); sync_itr++) {
-        if(sync_itr->produced_block_limit == 0 || 
-           chain_state.head_height - sync_itr->latest_produced_block_height <= sync_itr->produced_block_limit) {
-            active_synchronizers.push_back(sync_itr->synchronizer);
+    // count active synchronizers, the maintained counter is used once poolreg.xsat has initialized it
+    uint64_t total_synchronizers = 0;
+    auto num_active_synchronizers = pool::get_num_active_synchronizers(chain_state.head_height);
+    if (num_active_synchronizers.has_value()) {
+        total_synchronizers = num_active_synchronizers.value();
+    } else {
+        for(auto sync_itr = _synchronizer.begin(); sync_itr != _synchronizer.end(); sync_itr++) {
+            if(sync_itr->produced_block_limit == 0 || 
+               chain_state.head_height - sync_itr->latest_produced_block_height <= sync_itr->produced_block_limit) {
+                total_synchronizers++;
+            }
         }
     }
 
-    const uint64_t total_synchronizers = active_synchronizers.size();
     const uint64_t required_votes = (total_synchronizers / 2) + 1;
     const auto now = time_point_sec(current_time_point());
     if (pending_itr == ub) {
@@ -496,8 +919,25 @@ void block_endorse::migrate_endorsements(const uint64_t src_scope) {
     // foreach in src_endorsements
     auto it = src_endorsements.begin();
     while (it != src_endorsements.end()) {
+        auto row = *it;
+        // final rows are never erased, so the vote bitmaps are expanded instead of pinning the eligible snapshot
+        if (row.votes.has_value()) {
+            const auto& votes = row.votes.value();
+            auto snapshot = endorse_manage::find_eligible_snapshot(votes.validator_set_id);
+            check(snapshot.has_value(), "blkendt.xsat: [eligibles] does not exists");
+            for (uint16_t index = 0; index < snapshot->validators.size(); index++) {
+                const auto& validator = snapshot->validators[index];
+                if (votes.is_provided(index)) {
+                    row.provider_validators.push_back(
+                        {.account = validator.account, .staking = validator.staking, .created_at = time_point_sec()});
+                } else if (votes.is_requested(index)) {
+                    row.requested_validators.push_back({.account = validator.account, .staking = validator.staking});
+                }
+            }
+            row.votes.reset();
+        }
         dest_endorsements.emplace(get_self(), [&](auto& new_row) {
-            new_row = *it; // copy endorsement_row content
+            new_row = row; // copy endorsement_row content
             new_row.id = dest_endorsements.available_primary_key();
         });
         it = src_endorsements.erase(it);
@@ -7,6 +7,8 @@
 #include <eosio/binary_extension.hpp>
 #include "../internal/defines.hpp"
 #include "../internal/utils.hpp"
+#include <endrmng.xsat/endrmng.xsat.hpp>
+#include <utxomng.xsat/utxomng.xsat.hpp>
 
 using namespace eosio;
 using namespace std;
@@ -27,6 +29,7 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
      * - `{uint16_t} consensus_interval_seconds` - the interval in seconds between consensus rounds.
      * - `{uint64_t} xsat_stake_activation_height` - block height at which XSAT staking feature is activated
      * - `{asset} min_xsat_qualification` - the minimum pledge amount of xast to become a validator
+     * - `{uint16_t} committee_size` - number of validators sampled per block for snapshot-based endorsements, 0 means every requested validator votes
      *
      * ### example
      *
@@ -40,7 +43,8 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
      *   "min_xsat_qualification": "21000.00000000 XSAT",
 
      *   "min_btc_qualification": "100.00000000 BTC",
-     *   "validator_active_vote_count": 2
+     *   "validator_active_vote_count": 2,
+     *   "committee_size": 64
      * }
      * ```
      */
@@ -55,6 +59,7 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
         binary_extension<asset> min_btc_qualification;
         binary_extension<uint64_t> xsat_reward_height;
         binary_extension<uint8_t> validator_active_vote_count;
+        binary_extension<uint16_t> committee_size;
 
         bool is_xsat_consensus_active(const uint64_t height) const {
             return height >= xsat_stake_activation_height;
@@ -71,6 +76,10 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
         uint8_t get_validator_active_vote_count() const {
             return validator_active_vote_count.has_value() ? validator_active_vote_count.value() : 0;
         }
+
+        uint16_t get_committee_size() const {
+            return committee_size.has_value() ? committee_size.value() : 0;
+        }
     };
     typedef eosio::singleton<"config"_n, config_row> config_table;
 
@@ -117,6 +126,57 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
         time_point_sec created_at;
     };
 
+    /**
+     * ## STRUCT `endorsement_votes`
+     *
+     * - `{uint64_t} validator_set_id` - id of the eligible snapshot of `endrmng.xsat` the bitmaps index into
+     * - `{std::vector<uint8_t>} requested` - bitmap over the validator set, bit `i` is set when validator `i` is requested
+     * - `{std::vector<uint8_t>} provided` - bitmap over the validator set, bit `i` is set when validator `i` has endorsed
+     * - `{uint16_t} num_validators` - number of requested validators
+     * - `{uint16_t} num_providers` - number of validators that have endorsed
+     * - `{uint64_t} total_staking` - staking sum of the requested validators
+     * - `{uint64_t} provided_staking` - staking sum of the validators that have endorsed
+     * - `{uint64_t} consensus_staking` - staking sum of the validators that endorsed until consensus was reached
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "validator_set_id": 12,
+     *   "requested": "0f",
+     *   "provided": "05",
+     *   "num_validators": 4,
+     *   "num_providers": 2,
+     *   "total_staking": "40000000000",
+     *   "provided_staking": "20000000000",
+     *   "consensus_staking": 0
+     * }
+     * ```
+     */
+    struct endorsement_votes {
+        uint64_t validator_set_id;
+        std::vector<uint8_t> requested;
+        std::vector<uint8_t> provided;
+        uint16_t num_validators;
+        uint16_t num_providers;
+        uint64_t total_staking;
+        uint64_t provided_staking;
+        uint64_t consensus_staking;
+
+        bool is_requested(const uint16_t index) const { return requested[index / 8] & (1 << (index % 8)); }
+
+        bool is_provided(const uint16_t index) const { return provided[index / 8] & (1 << (index % 8)); }
+
+        void provide(const uint16_t index, const uint64_t staking) {
+            provided[index / 8] |= 1 << (index % 8);
+            num_providers++;
+            provided_staking += staking;
+            if (num_providers == xsat::utils::num_reached_consensus(num_validators)) {
+                consensus_staking = provided_staking;
+            }
+        }
+    };
+
     /**
      * ## TABLE `endorsements`
      *
@@ -127,6 +187,8 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
      * - `{checksum256} hash` - endorsement block hash
      * - `{std::vector<requested_validator_info>} requested_validators` - list of unendorsed validators
      * - `{std::vector<provider_validator_info>} provider_validators` - list of endorsed validators
+     * - `{binary_extension<endorsement_votes>} votes` - vote bitmaps, set instead of the validator lists when the
+     * endorsement was created from an eligible validator snapshot
      *
      * ### example
      *
@@ -152,24 +214,66 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
         checksum256 hash;
         std::vector<requested_validator_info> requested_validators;
         std::vector<provider_validator_info> provider_validators;
+        binary_extension<endorsement_votes> votes;
         uint64_t primary_key() const { return id; }
         checksum256 by_hash() const { return hash; }
 
-        uint16_t num_validators() const { return requested_validators.size() + provider_validators.size(); }
+        uint16_t num_validators() const {
+            return votes.has_value() ? votes.value().num_validators
+                                     : requested_validators.size() + provider_validators.size();
+        }
+
+        uint16_t num_providers() const {
+            return votes.has_value() ? votes.value().num_providers : provider_validators.size();
+        }
 
         uint64_t num_reached_consensus() const {
-            return xsat::utils::num_reached_consensus(requested_validators.size() + provider_validators.size());
+            return xsat::utils::num_reached_consensus(num_validators());
         }
 
         bool reached_consensus() const {
-            return provider_validators.size() > 0 && provider_validators.size() >= num_reached_consensus();
+            return num_providers() > 0 && num_providers() >= num_reached_consensus();
         }
     };
     typedef eosio::multi_index<
         "endorsements"_n, endorsement_row,
         eosio::indexed_by<"byhash"_n, const_mem_fun<endorsement_row, checksum256, &endorsement_row::by_hash>>>
         endorsement_table;
-        
+
+    /**
+     * ## TABLE `valsetinfo`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - id of an eligible snapshot of `endrmng.xsat` referenced by endorsements, which is kept
+     * unchanged while this row exists
+     * - `{uint16_t} num_validators` - number of validators in the snapshot
+     * - `{uint64_t} last_height` - the highest endorsement height referencing the snapshot
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 12,
+     *   "num_validators": 4,
+     *   "last_height": 840000
+     * }
+     * ```
+     */
+    struct [[eosio::table]] validator_set_info_row {
+        uint64_t id;
+        uint16_t num_validators;
+        uint64_t last_height;
+        uint64_t primary_key() const { return id; }
+        uint64_t by_last_height() const { return last_height; }
+    };
+    typedef eosio::multi_index<
+        "valsetinfo"_n, validator_set_info_row,
+        eosio::indexed_by<"bylastheight"_n,
+                          const_mem_fun<validator_set_info_row, uint64_t, &validator_set_info_row::by_last_height>>>
+        validator_set_info_table;
+
     /**
      * ## TABLE `revote_record`
      *
@@ -264,6 +368,51 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
     [[eosio::action]]
     void endorse(const name& validator, const uint64_t height, const checksum256& hash);
 
+    /**
+     * ## ACTION `endorses`
+     *
+     * - **authority**: `validator`
+     *
+     * > Endorse consecutive blocks with a single fee payment and a single vote bookkeeping update
+     *
+     * ### params
+     *
+     * - `{name} validator` - validator account
+     * - `{uint64_t} start_height` - the height of the first block to endorse
+     * - `{std::vector<checksum256>} hashes` - the hashes of the blocks from `start_height` onwards, up to 32
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action blkendt.xsat endorses '["alice", 840000, ["0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5", "00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463"]]' -p alice
+     * ```
+     */
+    [[eosio::action]]
+    void endorses(const name& validator, const uint64_t start_height, const std::vector<checksum256>& hashes);
+
+    /**
+     * ## ACTION `endorsebatch`
+     *
+     * - **authority**: every account in `validators`
+     *
+     * > Endorse a block on behalf of several validators in one transaction, usually submitted by a relayer.
+     * > Quorum is evaluated once after all votes are counted.
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - to endorse the height of the block
+     * - `{checksum256} hash` - to endorse the hash of the block
+     * - `{std::vector<name>} validators` - validator accounts, each must sign the transaction
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action blkendt.xsat endorsebatch '[840000, "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5", ["alice", "bob"]]' -p alice -p bob
+     * ```
+     */
+    [[eosio::action]]
+    void endorsebatch(const uint64_t height, const checksum256& hash, const std::vector<name>& validators);
+
     /**
      * ## ACTION `erase`
      *
@@ -284,6 +433,27 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
     [[eosio::action]]
     void erase(const uint64_t height);
 
+    /**
+     * ## ACTION `erasefork`
+     *
+     * - **authority**: `utxomng.xsat`
+     *
+     * > To erase the endorsements of a block on a losing fork
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - height of the block
+     * - `{checksum256} hash` - hash of the block
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action blkendt.xsat erasefork '[840000, "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5"]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void erasefork(const uint64_t height, const checksum256& hash);
+
 #ifdef DEBUG
     [[eosio::action]]
     void cleartable(const name table_name, const optional<uint64_t> scope, const optional<uint64_t> max_rows);
@@ -352,12 +522,89 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
     [[eosio::action]]
     void setconheight(const uint64_t xsat_stake_activation_height, const uint64_t xsat_reward_height);
 
+    /**
+     * ## ACTION `setcommittee`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Set the committee size. When an endorsement is created from an eligible validator snapshot and more validators
+     * > are requested than `committee_size`, a stake-weighted committee is sampled from them, seeded by the block hash,
+     * > and quorum is computed over the committee only.
+     *
+     * ### params
+     *
+     * - `{uint16_t} committee_size` - number of validators in the committee, 0 to disable, otherwise at least `min_validators`
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action blkendt.xsat setcommittee '[64]' -p blkendt.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void setcommittee(const uint16_t committee_size);
+
     using erase_action = eosio::action_wrapper<"erase"_n, &block_endorse::erase>;
+    using erasefork_action = eosio::action_wrapper<"erasefork"_n, &block_endorse::erasefork>;
     using setqualify_action = eosio::action_wrapper<"setqualify"_n, &block_endorse::setqualify>;
 
+    static std::vector<provider_validator_info> get_provider_validators(const endorsement_row& endorsement) {
+        if (!endorsement.votes.has_value()) {
+            return endorsement.provider_validators;
+        }
+
+        // bitmap records do not keep endorsement times
+        const auto& votes = endorsement.votes.value();
+        auto snapshot = endorse_manage::find_eligible_snapshot(votes.validator_set_id);
+        check(snapshot.has_value(), "blkendt.xsat: [eligibles] does not exists");
+        std::vector<provider_validator_info> result;
+        result.reserve(votes.num_providers);
+        for (uint16_t index = 0; index < snapshot->validators.size(); index++) {
+            if (votes.is_provided(index)) {
+                const auto& validator = snapshot->validators[index];
+                result.push_back(
+                    {.account = validator.account, .staking = validator.staking, .created_at = time_point_sec()});
+            }
+        }
+        return result;
+    }
+
    private:
+    // position and staking of a validator in the eligible snapshot of the vote bitmaps
+    struct snapshot_member {
+        uint16_t index;
+        uint64_t staking;
+    };
+
+    // outcome of endorsing a single height
+    struct endorse_result {
+        bool record_vote = false;  // the vote is recorded by endrmng.xsat
+        optional<utxo_manage::endorsement_quorum> quorum;  // set when the endorsement of the validator's scope reached consensus
+        bool xsat_validator = false;
+    };
+
+    endorse_result endorse_block(const config_row& config, const utxo_manage::chain_state_row& chain_state,
+                                 const endorse_manage::validator_row& validator_row,
+                                 const endorse_manage::vote_activity_row& vote_activity, const uint64_t height,
+                                 const checksum256& hash);
+    void check_endorse_height(const config_row& config, const utxo_manage::chain_state_row& chain_state,
+                              const uint64_t height);
+    optional<utxo_manage::endorsement_quorum> get_reached_quorum(const uint64_t scope, const checksum256& hash);
+    static utxo_manage::endorsement_quorum get_quorum(const endorsement_row& endorsement);
+    void dispatch_consensus(const config_row& config, optional<utxo_manage::endorsement_quorum> btc_quorum,
+                            optional<utxo_manage::endorsement_quorum> xsat_quorum, const uint64_t height,
+                            const checksum256& hash);
+    void dispatch_consensus(const config_row& config, const endorse_result& result, const uint64_t height,
+                            const checksum256& hash);
     std::vector<requested_validator_info> get_valid_validator_by_btc_stake(const uint64_t height, const uint8_t consecutive_vote_count);
     std::vector<requested_validator_info> get_valid_validator_by_xsat_stake(const uint64_t height, const uint8_t consecutive_vote_count);
+    optional<endorse_manage::eligible_snapshot_row> get_eligible_snapshot(const config_row& config, const bool xsat_validator);
+    endorsement_votes get_requested_votes(const endorse_manage::eligible_snapshot_row& snapshot, const bool check_active,
+                                          const uint64_t height, const uint8_t consecutive_vote_count,
+                                          const endorse_manage::vote_activity_row& endorser_activity);
+    void sample_committee(endorsement_votes& votes, const endorse_manage::eligible_snapshot_row& snapshot,
+                          const checksum256& hash, const uint16_t committee_size);
+    void save_validator_set(const endorse_manage::eligible_snapshot_row& snapshot, const uint64_t height);
     void process_revote_consensus(const uint64_t height);
     void migrate_endorsements(const uint64_t src_scope);
 
@@ -367,4 +614,5 @@ class [[eosio::contract("blkendt.xsat")]] block_endorse : public contract {
 #endif
    private:
     config_table _config = config_table(_self, _self.value);
+    validator_set_info_table _validator_set_info = validator_set_info_table(_self, _self.value);
 };
@@ -17,6 +17,8 @@ void block_endorse::cleartable(const name table_name, const optional<uint64_t> s
 
     if (table_name == "endorsements"_n)
         clear_table(_endorsement, rows_to_clear);
+    else if (table_name == "valsetinfo"_n)
+        clear_table(_validator_set_info, rows_to_clear);
     else if (table_name == "config"_n)
         _config.remove();
     else
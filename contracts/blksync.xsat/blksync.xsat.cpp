@@ -124,6 +124,10 @@ void block_sync::initbucket(const name& synchronizer, const uint64_t height, con
     // log
     block_sync::bucketlog_action _bucketlog(get_self(), {get_self(), "active"_n});
     _bucketlog.send(bucket_id, synchronizer, height, hash, block_size, num_chunks, chunk_size);
+
+    // timeline
+    utxo_manage::recordstage_action _recordstage(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+    _recordstage.send(height, hash, utxo_manage::stage_bucket_init);
 }
 
 //@auth synchronizer
@@ -190,6 +194,12 @@ void block_sync::pushchunk(const name& synchronizer, const uint64_t height, cons
     // log
     block_sync::chunklog_action _chunklog(get_self(), {get_self(), "active"_n});
     _chunklog.send(block_bucket_itr->bucket_id, chunk_id, block_bucket_itr->uploaded_num_chunks);
+
+    // timeline
+    if (block_bucket_itr->status == upload_complete) {
+        utxo_manage::recordstage_action _recordstage(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+        _recordstage.send(height, hash, utxo_manage::stage_upload_complete);
+    }
 }
 
 //@auth synchronizer
@@ -415,6 +425,9 @@ block_sync::verify_block_result block_sync::verify(const name& synchronizer, con
         }
 
         if (status == verify_pass) {
+            utxo_manage::recordstage_action _recordstage(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+            _recordstage.send(height, hash, utxo_manage::stage_verify_pass);
+
             utxo_manage::consensus_action _consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
             _consensus.send(height, hash);
         }
@@ -435,6 +448,9 @@ block_sync::verify_block_result block_sync::verify(const name& synchronizer, con
     check(block_miner_itr->expired_block_num <= current_block_number(),
           "2022:blksync.xsat::verify: waiting for miners to produce blocks");
 
+    utxo_manage::recordstage_action _recordstage(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
+    _recordstage.send(height, hash, utxo_manage::stage_verify_pass);
+
     utxo_manage::consensus_action _consensus(UTXO_MANAGE_CONTRACT, {get_self(), "active"_n});
     _consensus.send(height, hash);
 
@@ -1,6 +1,7 @@
 #include <custody.xsat/custody.xsat.hpp>
 #include <endrmng.xsat/endrmng.xsat.hpp>
 #include <utxomng.xsat/utxomng.xsat.hpp>
+#include <bitcoin/core/transaction.hpp>
 
 #ifdef DEBUG
 #include <bitcoin/script/address.hpp>
@@ -164,6 +165,81 @@ void custody::verifyresult(const name& account, const uint8_t is_valid, const st
     });
 }
 
+void custody::verifyspv(const name& verifier, const std::vector<spv_proof>& proofs) {
+    require_auth(verifier);
+    check(!proofs.empty(), "custody.xsat::verifyspv: proofs cannot be empty");
+
+    utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    auto chain_state = _chain_state.get();
+
+    for (const auto& proof : proofs) {
+        auto enroll_itr = _enrollment.require_find(proof.account.value, "custody.xsat::verifyspv: account not enrolled");
+        check(enroll_itr->is_valid == 0, "custody.xsat::verifyspv: account verification already completed");
+        check(!enroll_itr->btc_address.empty(), "custody.xsat::verifyspv: please submit the bitcoin address by verifytx first");
+        check(proof.height > enroll_itr->start_height && proof.height <= enroll_itr->end_height,
+              "custody.xsat::verifyspv: the transaction was not mined during the enrollment period");
+        check(proof.height <= chain_state.irreversible_height, "custody.xsat::verifyspv: the block is not irreversible");
+        check(proof.branch.size() < 32 && proof.index >> proof.branch.size() == 0,
+              "custody.xsat::verifyspv: index exceeds the merkle branch");
+
+        std::vector<char> raw_transaction(proof.raw_transaction.begin(), proof.raw_transaction.end());
+        eosio::datastream<const char*> ds(raw_transaction.data(), raw_transaction.size());
+        bitcoin::core::transaction transaction(&raw_transaction);
+        ds >> transaction;
+        check(ds.remaining() == 0, "custody.xsat::verifyspv: invalid raw transaction");
+
+        auto tx_hash = transaction.merkle_hash();
+        const checksum256 txid = bitcoin::be_checksum256_from_uint(tx_hash);
+        if (enroll_itr->txid != checksum256()) {
+            check(enroll_itr->txid == txid, "custody.xsat::verifyspv: txid does not match the submitted txid");
+        }
+
+        std::vector<bitcoin::uint256_t> branch;
+        branch.reserve(proof.branch.size());
+        for (const auto& sibling : proof.branch) {
+            branch.push_back(bitcoin::be_uint_from_checksum256(sibling));
+        }
+        const checksum256 merkle = get_irreversible_merkle(chain_state, proof.height);
+        check(bitcoin::compute_merkle_root_from_branch(tx_hash, branch, proof.index) == bitcoin::be_uint_from_checksum256(merkle),
+              "custody.xsat::verifyspv: merkle branch does not match the block header");
+
+        auto scriptpubkey = bitcoin::utility::address_to_scriptpubkey(enroll_itr->btc_address);
+        auto output_itr = std::find_if(transaction.outputs.begin(), transaction.outputs.end(), [&](const auto& output) {
+            return output.value == enroll_itr->random && output.script.data == scriptpubkey;
+        });
+        check(output_itr != transaction.outputs.end(), "custody.xsat::verifyspv: no output pays random to btc_address");
+
+        _enrollment.modify(enroll_itr, same_payer, [&](auto& row) {
+            row.txid = txid;
+            row.index = output_itr - transaction.outputs.begin();
+            row.is_valid = 1;
+            row.verification_result = "spv verified by " + verifier.to_string();
+        });
+    }
+}
+
+checksum256 custody::get_irreversible_merkle(const utxo_manage::chain_state_row& chain_state, const uint64_t height) {
+    auto block = utxo_manage::get_irreversible_block(height);
+    if (block.has_value()) {
+        return block->merkle;
+    }
+
+    // Irreversible blocks that have not been migrated yet are still in consensusblk
+    utxo_manage::consensus_block_table _consensus_block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+    auto consensus_block_idx = _consensus_block.get_index<"byblockid"_n>();
+    auto block_height = chain_state.irreversible_height;
+    auto block_hash = chain_state.irreversible_hash;
+    while (true) {
+        auto consensus_block_itr = consensus_block_idx.require_find(xsat::utils::compute_block_id(block_height, block_hash),
+                                                                    "custody.xsat::verifyspv: block header does not exist");
+        if (block_height == height) {
+            return consensus_block_itr->merkle;
+        }
+        block_height--;
+        block_hash = consensus_block_itr->previous_block_hash;
+    }
+}
+
 template <typename T>
 uint64_t custody::get_current_staking_value(T& itr) {
     endorse_manage::evm_staker_table _staking(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
@@ -7,6 +7,7 @@
 #include <eosio/binary_extension.hpp>
 #include <sstream>
 #include <endrmng.xsat/endrmng.xsat.hpp>
+#include <utxomng.xsat/utxomng.xsat.hpp>
 #include <btc.xsat/btc.xsat.hpp>
 #include <bitcoin/utility/address_converter.hpp>
 #include "../internal/defines.hpp"
@@ -159,6 +160,62 @@ public:
     [[eosio::action]]
     void verifyresult(const name& account, const uint8_t is_valid, const string& verification_result);
 
+    /**
+     * ## STRUCT `spv_proof`
+     *
+     * ### params
+     *
+     * - `{name} account` - enrolled account whose verification transaction is proven
+     * - `{uint64_t} height` - height of the block containing the transaction
+     * - `{uint32_t} index` - position of the transaction in the block
+     * - `{std::vector<uint8_t>} raw_transaction` - serialized transaction
+     * - `{std::vector<checksum256>} branch` - merkle siblings from the transaction up to the root, as returned by
+     * `utxomng.xsat::gettxproof`
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "account": "myaccount",
+     *   "height": 840010,
+     *   "index": 1,
+     *   "raw_transaction": "02000000000101...",
+     *   "branch": ["a0db149ace545beabbd87a8d6b20ffd6aa3b5a50e58add49a3d435f898c272cf", ...]
+     * }
+     * ```
+     */
+    struct spv_proof {
+        name account;
+        uint64_t height;
+        uint32_t index;
+        std::vector<uint8_t> raw_transaction;
+        std::vector<checksum256> branch;
+    };
+
+    /**
+     * ## ACTION `verifyspv`
+     *
+     * - **authority**: `verifier`
+     *
+     * > Verify enrollment transactions on chain against the irreversible block headers stored in `utxomng.xsat`,
+     * without waiting for `verifyresult`. The transaction must be mined within the enrollment period and pay `random`
+     * satoshis to the `btc_address` submitted by `verifytx`.
+     *
+     * ### params
+     *
+     * - `{name} verifier` - account submitting the proofs
+     * - `{std::vector<spv_proof>} proofs` - one proof per enrolled account
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action custody.xsat verifyspv '["myaccount", [{"account": "myaccount", "height": 840010, "index": 1,
+     * "raw_transaction": "02000000000101...", "branch": ["a0db149ace545beabbd87a8d6b20ffd6aa3b5a50e58add49a3d435f898c272cf"]}]]' -p myaccount
+     * ```
+     */
+    [[eosio::action]]
+    void verifyspv(const name& verifier, const std::vector<spv_proof>& proofs);
+
 #ifdef DEBUG
     [[eosio::action]]
     void cleartable(const name table_name, const optional<name> scope, const optional<uint64_t> max_rows);
@@ -303,6 +360,8 @@ private:
 
     uint64_t next_custody_id();
 
+    checksum256 get_irreversible_merkle(const utxo_manage::chain_state_row& chain_state, const uint64_t height);
+
 #ifdef DEBUG
     template <typename T>
     void clear_table(T& table, uint64_t rows_to_clear);
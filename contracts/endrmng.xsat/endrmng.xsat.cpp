@@ -857,6 +857,7 @@ void endorse_manage::staking_change(validator_table::const_iterator& validator_i
             row.active_flag = active_flag.value();
         }
     });
+    update_eligible(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.total_staking += quantity;
@@ -1098,6 +1099,7 @@ asset endorse_manage::evm_stake_xsat_without_auth(const checksum160& proxy, cons
 
         row.active_flag = active_flag;
     });
+    update_eligible(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking += quantity;
@@ -1153,6 +1155,7 @@ asset endorse_manage::evm_unstake_xsat_without_auth(const checksum160& proxy, co
 
         row.active_flag = active_flag;
     });
+    update_eligible(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking -= quantity;
@@ -1197,6 +1200,7 @@ asset endorse_manage::stake_xsat_without_auth(const name& staker, const name& va
         row.xsat_quantity += quantity;
         row.latest_staking_time = current_time_point();
     });
+    update_eligible(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking += quantity;
@@ -1226,6 +1230,7 @@ asset endorse_manage::unstake_xsat_without_auth(const name& staker, const name&
         row.xsat_quantity -= quantity;
         row.latest_staking_time = current_time_point();
     });
+    update_eligible(*validator_itr);
 
     stat_row stat = _stat.get_or_default();
     stat.xsat_total_staking -= quantity;
@@ -1551,6 +1556,7 @@ void endorse_manage::evmsetstaker(const name& validator, const checksum160& stak
                 row.reward_address = stake_addr;
             }
         });
+        update_eligible(*validator_itr);
         
         // send log 
         endorse_manage::setstakerlog_action _setstakerlog(get_self(), {get_self(), "active"_n});
@@ -1575,6 +1581,7 @@ void endorse_manage::evmsetstaker(const name& validator, const checksum160& stak
     _validator.emplace(get_self(), [&](auto& row) {
         row = new_validator;
     });
+    update_eligible(new_validator);
 
     // send log
     endorse_manage::setstakerlog_action _setstakerlog(get_self(), {get_self(), "active"_n});
@@ -1694,6 +1701,7 @@ void endorse_manage::setstakebase(const asset& xsat_base_stake, const asset& btc
         _validator.modify(itr, get_self(), [&](auto& row) { row.active_flag = active; });
         itr++;
     }
+    rebuild_eligible(btc_base_stake.amount, xsat_base_stake.amount);
 
     // send action to blkendt.xsat update xsat base stake & btc base stake
     block_endorse::setqualify_action _setqualify(BLOCK_ENDORSE_CONTRACT, {get_self(), "active"_n});
@@ -1775,6 +1783,7 @@ void endorse_manage::updcreditstk(const name& validator, const bool is_close) {
             row.qualification = qualification;
             row.quantity = quantity;
         });
+        update_eligible(*validator_itr);
     } else {
         // copy current record to new_validator, then delete old record, and insert new record
         auto new_validator = *validator_itr;
@@ -1791,6 +1800,7 @@ void endorse_manage::updcreditstk(const name& validator, const bool is_close) {
         _validator.emplace(get_self(), [&](auto& row) {
             row = new_validator;
         });
+        update_eligible(new_validator);
     }
 }
 
@@ -1798,24 +1808,50 @@ void endorse_manage::updcreditstk(const name& validator, const bool is_close) {
 void endorse_manage::endorse(const name& validator, const uint64_t height) {
 
     require_auth(BLOCK_ENDORSE_CONTRACT);
+    record_votes(validator, {height});
+}
+
+//@auth blkendt.xsat
+[[eosio::action]]
+void endorse_manage::endorses(const name& validator, const std::vector<uint64_t>& heights) {
+    require_auth(BLOCK_ENDORSE_CONTRACT);
+
+    check(!heights.empty(), "endrmng.xsat::endorses: heights cannot be empty");
+    record_votes(validator, heights);
+}
+
+void endorse_manage::record_votes(const name& validator, const std::vector<uint64_t>& heights) {
     auto validator_itr = _validator.find(validator.value);
 
     if (validator_itr == _validator.end()) {
         return;
     }
-    
-    // check height
-    if (validator_itr->latest_consensus_block.has_value() ) {
-        check(height > validator_itr->latest_consensus_block.value(), "endrmng.xsat::endorse: height must be greater than the latest consensus block");
-    }
 
-    _validator.modify(validator_itr, get_self(), [&](auto& row) {
+    // check heights and fold them into the consecutive vote count, 0 means the validator has not voted yet
+    auto vote_activity = get_vote_activity(*validator_itr);
+    for (const auto height : heights) {
+        check(height > vote_activity.latest_consensus_block, "endrmng.xsat::endorse: height must be greater than the latest consensus block");
+
         // if the validator has not voted for the previous block, or the previous block is the current block, then the validator is consecutive
-        bool is_consecutive = row.latest_consensus_block.has_value() && (height == row.latest_consensus_block.value() + 1);
+        bool is_consecutive = vote_activity.latest_consensus_block > 0 && (height == vote_activity.latest_consensus_block + 1);
 
-        row.consecutive_vote_count = is_consecutive ? row.consecutive_vote_count.value_or(0ULL) + 1ULL : 1ULL;
-        row.latest_consensus_block = height;
-    });
+        vote_activity.consecutive_vote_count = is_consecutive ? vote_activity.consecutive_vote_count + 1ULL : 1ULL;
+        vote_activity.latest_consensus_block = height;
+    }
+
+    // vote counters live in their own small table so that a vote does not rewrite the validator row and its indexes
+    auto vote_activity_itr = _vote_activity.find(validator.value);
+    if (vote_activity_itr == _vote_activity.end()) {
+        _vote_activity.emplace(get_self(), [&](auto& row) {
+            row = vote_activity;
+        });
+    } else {
+        _vote_activity.modify(vote_activity_itr, same_payer, [&](auto& row) {
+            row = vote_activity;
+        });
+    }
+
+    const auto height = vote_activity.latest_consensus_block;
 
     // only BTC Validator
     if (validator_itr->role.has_value() && validator_itr->role.value() == 1) {
@@ -1874,6 +1910,148 @@ void endorse_manage::endorse(const name& validator, const uint64_t height) {
     }
 }
 
+//@auth get_self()
+[[eosio::action]]
+void endorse_manage::rebuildelig() {
+    require_auth(get_self());
+
+    block_endorse::config_table _blkconfig(BLOCK_ENDORSE_CONTRACT, BLOCK_ENDORSE_CONTRACT.value);
+    auto blkconfig = _blkconfig.get_or_default();
+    rebuild_eligible(blkconfig.get_btc_base_stake().amount, blkconfig.min_xsat_qualification.amount);
+}
+
+optional<endorse_manage::eligible_validator> endorse_manage::to_eligible(const validator_row& validator,
+                                                                         const uint8_t role,
+                                                                         const uint64_t min_qualification) {
+    // Same role and qualification rules as the validator scans in blkendt.xsat
+    auto validator_role = validator.role.has_value() ? validator.role.value() : 0;
+    if (validator_role != role) {
+        return std::nullopt;
+    }
+    auto qualification = role == 1 ? validator.xsat_quantity.amount : validator.qualification.amount;
+    if (qualification < 0 || static_cast<uint64_t>(qualification) < min_qualification) {
+        return std::nullopt;
+    }
+    auto staking = role == 1 ? validator.xsat_quantity.amount : validator.quantity.amount;
+    return eligible_validator{.account = validator.owner,
+                              .staking = static_cast<uint64_t>(staking),
+                              .active_flag = validator.active_flag.has_value() ? validator.active_flag.value() : uint8_t(1)};
+}
+
+void endorse_manage::update_eligible(const validator_row& validator) {
+    auto eligible_state = _eligible_state.get_or_default();
+    for (uint8_t role = 0; role <= 1; role++) {
+        auto snapshot_id = role == 1 ? eligible_state.xsat_snapshot_id : eligible_state.btc_snapshot_id;
+        // not built yet, blkendt.xsat scans the validators table instead
+        if (snapshot_id == 0) {
+            continue;
+        }
+        auto snapshot_itr = _eligible_snapshot.require_find(snapshot_id, "endrmng.xsat: [eligibles] does not exists");
+
+        auto eligible = to_eligible(validator, role, snapshot_itr->min_qualification);
+        const auto& current = snapshot_itr->validators;
+        auto itr = std::lower_bound(current.begin(), current.end(), validator.owner,
+                                    [](const eligible_validator& a, const name& b) {
+                                        return a.account < b;
+                                    });
+        bool exists = itr != current.end() && itr->account == validator.owner;
+        if (!eligible.has_value() && !exists) {
+            continue;
+        }
+        if (eligible.has_value() && exists && itr->staking == eligible->staking
+            && itr->active_flag == eligible->active_flag) {
+            continue;
+        }
+
+        auto offset = itr - current.begin();
+        auto apply = [&](std::vector<eligible_validator>& validators) {
+            if (!eligible.has_value()) {
+                validators.erase(validators.begin() + offset);
+            } else if (exists) {
+                validators[offset] = *eligible;
+            } else {
+                validators.insert(validators.begin() + offset, *eligible);
+            }
+        };
+
+        // the vote bitmaps of pending endorsements index into the snapshot, only then a new epoch is needed
+        if (!is_eligible_pinned(snapshot_id)) {
+            _eligible_snapshot.modify(snapshot_itr, same_payer, [&](auto& row) {
+                apply(row.validators);
+            });
+            continue;
+        }
+        auto validators = current;
+        apply(validators);
+        save_eligible(role, snapshot_itr->min_qualification, std::move(validators));
+    }
+}
+
+void endorse_manage::rebuild_eligible(const uint64_t min_btc_qualification, const uint64_t min_xsat_qualification) {
+    // the validators table is ordered by account, so both snapshots come out sorted
+    std::vector<eligible_validator> btc_validators;
+    std::vector<eligible_validator> xsat_validators;
+    for (auto itr = _validator.begin(); itr != _validator.end(); itr++) {
+        auto eligible = to_eligible(*itr, 0, min_btc_qualification);
+        if (eligible.has_value()) {
+            btc_validators.push_back(*eligible);
+        }
+        eligible = to_eligible(*itr, 1, min_xsat_qualification);
+        if (eligible.has_value()) {
+            xsat_validators.push_back(*eligible);
+        }
+    }
+    save_eligible(0, min_btc_qualification, std::move(btc_validators));
+    save_eligible(1, min_xsat_qualification, std::move(xsat_validators));
+}
+
+void endorse_manage::save_eligible(const uint8_t role, const uint64_t min_qualification,
+                                   std::vector<eligible_validator>&& validators) {
+    const auto now = time_point_sec(current_time_point());
+    auto eligible_state = _eligible_state.get_or_default();
+    auto& snapshot_id = role == 1 ? eligible_state.xsat_snapshot_id : eligible_state.btc_snapshot_id;
+    auto snapshot_itr = _eligible_snapshot.find(snapshot_id);
+    if (snapshot_itr != _eligible_snapshot.end() && !is_eligible_pinned(snapshot_id)) {
+        _eligible_snapshot.modify(snapshot_itr, same_payer, [&](auto& row) {
+            row.min_qualification = min_qualification;
+            row.validators = std::move(validators);
+        });
+        return;
+    }
+    if (snapshot_itr != _eligible_snapshot.end()) {
+        _eligible_snapshot.modify(snapshot_itr, same_payer, [&](auto& row) {
+            row.superseded_at = now;
+        });
+    }
+
+    eligible_state.epoch++;
+    _eligible_snapshot.emplace(get_self(), [&](auto& row) {
+        row.id = eligible_state.epoch;
+        row.role = role;
+        row.min_qualification = min_qualification;
+        row.validators = std::move(validators);
+    });
+    snapshot_id = eligible_state.epoch;
+    _eligible_state.set(eligible_state, get_self());
+
+    // Superseded epochs stay readable for a retention period, then one is dropped per new epoch. The vote bitmaps of
+    // blkendt.xsat are resolved against the snapshot, so it is kept while an endorsement references it
+    auto superseded_idx = _eligible_snapshot.get_index<"bysuperseded"_n>();
+    auto superseded_itr = superseded_idx.begin();
+    if (superseded_itr != superseded_idx.end() && superseded_itr->superseded_at != time_point_sec()
+        && superseded_itr->superseded_at.sec_since_epoch() + ELIGIBLE_SNAPSHOT_RETENTION_SECONDS
+               <= now.sec_since_epoch()
+        && !is_eligible_pinned(superseded_itr->id)) {
+        superseded_idx.erase(superseded_itr);
+    }
+}
+
+bool endorse_manage::is_eligible_pinned(const uint64_t snapshot_id) {
+    // blkendt.xsat keeps a validator set row for every snapshot referenced by an endorsement that is not yet erased
+    block_endorse::validator_set_info_table _validator_set_info(BLOCK_ENDORSE_CONTRACT, BLOCK_ENDORSE_CONTRACT.value);
+    return _validator_set_info.find(snapshot_id) != _validator_set_info.end();
+}
+
 [[eosio::action]]
 void endorse_manage::setcreditwei(const uint64_t credit_weight, const uint64_t credit_weight_block) {
     require_auth(get_self());
@@ -469,6 +469,132 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     };
     typedef eosio::singleton<"stat"_n, stat_row> stat_table;
 
+    /**
+     * ## STRUCT `eligible_validator`
+     *
+     * - `{name} account` - validator account
+     * - `{uint64_t} staking` - the validator's staking amount, BTC for BTC validators and XSAT for XSAT validators
+     * - `{uint8_t} active_flag` - the validator's active flag, 1 when the flag has never been set
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "account": "alice",
+     *   "staking": "10000000000",
+     *   "active_flag": 1
+     * }
+     * ```
+     */
+    struct eligible_validator {
+        name account;
+        uint64_t staking;
+        uint8_t active_flag;
+    };
+
+    /**
+     * ## TABLE `eligibles`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - the epoch in which the snapshot was created, it is updated in place until an endorsement of
+     * `blkendt.xsat` references it
+     * - `{uint8_t} role` - validator role, 0: BTC, 1: XSAT
+     * - `{uint64_t} min_qualification` - the qualification the snapshot was built with
+     * - `{std::vector<eligible_validator>} validators` - validators with the role and qualification, sorted by account
+     * - `{time_point_sec} superseded_at` - the time the snapshot was replaced by a newer epoch, zero while current. It is
+     * dropped after `ELIGIBLE_SNAPSHOT_RETENTION_SECONDS` once no endorsement of `blkendt.xsat` references it
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 12,
+     *   "role": 0,
+     *   "min_qualification": "10000000000",
+     *   "validators": [{
+     *     "account": "alice",
+     *     "staking": "10000000000",
+     *     "active_flag": 1
+     *   }],
+     *   "superseded_at": "1970-01-01T00:00:00"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] eligible_snapshot_row {
+        uint64_t id;
+        uint8_t role;
+        uint64_t min_qualification;
+        std::vector<eligible_validator> validators;
+        time_point_sec superseded_at;
+        uint64_t primary_key() const { return id; }
+        uint64_t by_superseded() const {
+            return superseded_at == time_point_sec() ? std::numeric_limits<uint64_t>::max() : superseded_at.sec_since_epoch();
+        }
+    };
+    typedef eosio::multi_index<
+        "eligibles"_n, eligible_snapshot_row,
+        eosio::indexed_by<"bysuperseded"_n,
+                          const_mem_fun<eligible_snapshot_row, uint64_t, &eligible_snapshot_row::by_superseded>>>
+        eligible_snapshot_table;
+
+    /**
+     * ## TABLE `eligstate`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} epoch` - incremented every time an eligible validator snapshot changes while it is referenced by a
+     * pending endorsement, which then keeps reading the superseded snapshot
+     * - `{uint64_t} btc_snapshot_id` - id of the current BTC validator snapshot, 0 if not built
+     * - `{uint64_t} xsat_snapshot_id` - id of the current XSAT validator snapshot, 0 if not built
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "epoch": 12,
+     *   "btc_snapshot_id": 12,
+     *   "xsat_snapshot_id": 9
+     * }
+     * ```
+     */
+    struct [[eosio::table]] eligible_state_row {
+        uint64_t epoch;
+        uint64_t btc_snapshot_id;
+        uint64_t xsat_snapshot_id;
+    };
+    typedef eosio::singleton<"eligstate"_n, eligible_state_row> eligible_state_table;
+
+    /**
+     * ## TABLE `voteacts`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{name} validator` - validator account
+     * - `{uint64_t} consecutive_vote_count` - number of consecutive blocks endorsed by the validator
+     * - `{uint64_t} latest_consensus_block` - the latest block height endorsed by the validator
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "validator": "alice",
+     *   "consecutive_vote_count": 12,
+     *   "latest_consensus_block": 840012
+     * }
+     * ```
+     */
+    struct [[eosio::table]] vote_activity_row {
+        name validator;
+        uint64_t consecutive_vote_count;
+        uint64_t latest_consensus_block;
+        uint64_t primary_key() const { return validator.value; }
+    };
+    typedef eosio::multi_index<"voteacts"_n, vote_activity_row> vote_activity_table;
+
     /**
      * ## ACTION `setdonateacc`
      *
@@ -1238,9 +1364,60 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     [[eosio::action]]
     void endorse(const name& validator, const uint64_t height);
 
+    [[eosio::action]]
+    void endorses(const name& validator, const std::vector<uint64_t>& heights);
+
     [[eosio::action]]
     void setdepproxy(const checksum160& btc_deposit_proxy, const checksum160& xsat_deposit_proxy);
 
+    /**
+     * ## ACTION `rebuildelig`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Rebuild the BTC and XSAT eligible validator snapshots from the validators table, using the qualifications
+     * configured in `blkendt.xsat`. Snapshots are then kept up to date by stake, role and active flag changes.
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action endrmng.xsat rebuildelig '[]' -p endrmng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void rebuildelig();
+
+    // Validators that have not endorsed since `voteacts` was introduced keep their counters in the validator row
+    static vote_activity_row get_vote_activity(const validator_row& validator) {
+        vote_activity_table _vote_activity(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+        auto vote_activity_itr = _vote_activity.find(validator.owner.value);
+        if (vote_activity_itr != _vote_activity.end()) {
+            return *vote_activity_itr;
+        }
+        return {.validator = validator.owner,
+                .consecutive_vote_count = validator.consecutive_vote_count.value_or(0ULL),
+                .latest_consensus_block = validator.latest_consensus_block.value_or(0ULL)};
+    }
+
+    static optional<eligible_snapshot_row> get_eligible_snapshot(const uint8_t role) {
+        eligible_state_table _eligible_state(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+        auto eligible_state = _eligible_state.get_or_default();
+        auto snapshot_id = role == 1 ? eligible_state.xsat_snapshot_id : eligible_state.btc_snapshot_id;
+        if (snapshot_id == 0) {
+            return std::nullopt;
+        }
+        return find_eligible_snapshot(snapshot_id);
+    }
+
+    static optional<eligible_snapshot_row> find_eligible_snapshot(const uint64_t snapshot_id) {
+        eligible_snapshot_table _eligible_snapshot(ENDORSER_MANAGE_CONTRACT, ENDORSER_MANAGE_CONTRACT.value);
+        auto snapshot_itr = _eligible_snapshot.find(snapshot_id);
+        if (snapshot_itr == _eligible_snapshot.end()) {
+            return std::nullopt;
+        }
+        return *snapshot_itr;
+    }
+
     // logs
     [[eosio::action]]
     void validatorlog(const name& proxy, const name& validator, const string& financial_account,
@@ -1406,6 +1583,7 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     
     using regvldtorlog_action = eosio::action_wrapper<"regvldtorlog"_n, &endorse_manage::regvldtorlog>;
     using endorse_action = eosio::action_wrapper<"endorse"_n, &endorse_manage::endorse>;
+    using endorses_action = eosio::action_wrapper<"endorses"_n, &endorse_manage::endorses>;
     using setstakerlog_action = eosio::action_wrapper<"setstakerlog"_n, &endorse_manage::setstakerlog>;
     using setrwdadrlog_action = eosio::action_wrapper<"setrwdadrlog"_n, &endorse_manage::setrwdadrlog>;
 
@@ -1431,9 +1609,25 @@ class [[eosio::contract("endrmng.xsat")]] endorse_manage : public contract {
     credit_proxy_table _credit_proxy = credit_proxy_table(_self, _self.value);
     stat_table _stat = stat_table(_self, _self.value);
     config_table _config = config_table(_self, _self.value);
+    eligible_snapshot_table _eligible_snapshot = eligible_snapshot_table(_self, _self.value);
+    eligible_state_table _eligible_state = eligible_state_table(_self, _self.value);
+    vote_activity_table _vote_activity = vote_activity_table(_self, _self.value);
 
     uint64_t next_staking_id();
 
+    void record_votes(const name& validator, const std::vector<uint64_t>& heights);
+
+    void update_eligible(const validator_row& validator);
+
+    void rebuild_eligible(const uint64_t min_btc_qualification, const uint64_t min_xsat_qualification);
+
+    void save_eligible(const uint8_t role, const uint64_t min_qualification, std::vector<eligible_validator>&& validators);
+
+    bool is_eligible_pinned(const uint64_t snapshot_id);
+
+    static optional<eligible_validator> to_eligible(const validator_row& validator, const uint8_t role,
+                                                    const uint64_t min_qualification);
+
     void token_transfer(const name& from, const string& to, const extended_asset& value);
 
     void token_transfer(const name& from, const name& to, const extended_asset& value, const string& memo);
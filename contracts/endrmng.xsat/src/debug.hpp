@@ -29,6 +29,12 @@ void endorse_manage::cleartable(const name table_name, const optional<name> scop
         clear_table(_evm_proxy, rows_to_clear);
     else if (table_name == "whitelist"_n)
         clear_table(_whitelist, rows_to_clear);
+    else if (table_name == "eligibles"_n)
+        clear_table(_eligible_snapshot, rows_to_clear);
+    else if (table_name == "eligstate"_n)
+        _eligible_state.remove();
+    else if (table_name == "voteacts"_n)
+        clear_table(_vote_activity, rows_to_clear);
     else
         check(false, "endrmng.xsat::cleartable: [table_name] unknown table to clear");
 }
@@ -755,7 +755,9 @@ void gasfund::token_transfer(const name& from, const name& to, const extended_as
 }
 
 void gasfund::deldistribut(uint64_t start_height) {
-    require_auth(get_self());
+    if (!has_auth(UTXO_MANAGE_CONTRACT)) {
+        require_auth(get_self());
+    }
 
     auto _feestat_itr = _fees_stat.get_or_default();
     check(start_height < _feestat_itr.last_evm_height, 
@@ -767,8 +769,9 @@ void gasfund::deldistribut(uint64_t start_height) {
     
     // delete details
     distribute_detail_table _distribute_details(get_self(), start_height);
-    for (auto itr = _distribute_details.begin(); itr != _distribute_details.end(); itr++) {
-        _distribute_details.erase(itr);
+    auto itr = _distribute_details.begin();
+    while (itr != _distribute_details.end()) {
+        itr = _distribute_details.erase(itr);
     }
 
     // delete main distribute record
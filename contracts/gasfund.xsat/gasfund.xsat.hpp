@@ -296,6 +296,29 @@ public:
             _config.remove();
         }
     };
+
+    [[eosio::action]]
+    void setfeestat(const uint64_t last_height, const uint64_t last_evm_height) {
+        require_auth(get_self());
+        auto fees_stat = _fees_stat.get_or_default();
+        fees_stat.last_height = last_height;
+        fees_stat.last_evm_height = last_evm_height;
+        _fees_stat.set(fees_stat, get_self());
+    };
+
+    [[eosio::action]]
+    void adddistribut(const uint64_t start_height, const uint64_t end_height) {
+        require_auth(get_self());
+        _distributes.emplace(get_self(), [&](auto& row) {
+            row.start_height = start_height;
+            row.end_height = end_height;
+            row.total_fees = asset(0, BTC_SYMBOL);
+            row.enf_fees = asset(0, BTC_SYMBOL);
+            row.rams_fees = asset(0, BTC_SYMBOL);
+            row.consensus_fees = asset(0, BTC_SYMBOL);
+            row.total_xsat_rewards = asset(0, XSAT_SYMBOL);
+        });
+    };
 #endif
 
     // Log action
@@ -353,6 +376,7 @@ public:
     using evmclaim_action = eosio::action_wrapper<"evmclaim"_n, &gasfund::evmclaim>;
     using evmenfclaim_action = eosio::action_wrapper<"evmenfclaim"_n, &gasfund::evmenfclaim>;
     using evmramsclaim_action = eosio::action_wrapper<"evmramsclaim"_n, &gasfund::evmramsclaim>;
+    using deldistribut_action = eosio::action_wrapper<"deldistribut"_n, &gasfund::deldistribut>;
 
     // log action
     using configlog_action = eosio::action_wrapper<"configlog"_n, &gasfund::configlog>;
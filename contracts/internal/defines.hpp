@@ -95,8 +95,18 @@ static constexpr uint64_t SUBSIDY_HALVING_INTERVAL = 210000;
 
 static constexpr uint64_t BLOCK_HEADER_SIZE = 80;
 static constexpr uint64_t MAX_BLOCK_SIZE = 4LL * 1024 * 1024;
+static constexpr uint64_t MAX_VARINT_SIZE = 9;
 static constexpr uint8_t MAX_NUM_CHUNKS = 64;
 
+static constexpr uint64_t HEADERS_PER_CHUNK = 16;
+static constexpr uint64_t HEADER_RECORD_SIZE = 112;
+static constexpr uint64_t MAX_GC_HEIGHTS_PER_ACTION = 1000;
+static constexpr uint8_t COLD_UTXO_BUCKET_BITS = 24;
+static constexpr uint32_t PIPELINE_METRICS_WINDOW = 16;
+static constexpr uint16_t MAX_UTXO_QUERY_ROWS = 1000;
+static constexpr uint32_t ELIGIBLE_SNAPSHOT_RETENTION_SECONDS = 86400;
+static constexpr uint16_t MAX_ENDORSE_HEIGHTS_PER_ACTION = 32;
+
 static constexpr uint64_t DEFAULT_PRODUCTED_BLOCK_LIMIT = 432;
 static constexpr uint64_t DEFAULT_NUM_SLOTS = 2;
 static constexpr uint16_t MAX_NUM_SLOTS = 1000;
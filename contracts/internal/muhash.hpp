@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <eosio/check.hpp>
+#include <eosio/crypto.hpp>
+#include <vector>
+
+namespace xsat {
+
+    //  MuHash3072 multiset hash, every element is hashed to a number modulo the prime 2^3072 - 1103717 and the set is
+    //  the product of its elements. Removed elements are multiplied into a separate denominator, so the modular
+    //  inverse is only computed by `finalize`.
+    class muhash3072 {
+       public:
+        static constexpr uint32_t NUM_LIMBS = 96;
+        static constexpr uint32_t NUM_BYTES = NUM_LIMBS * 4;
+
+        muhash3072() {
+            numerator[0] = 1;
+            denominator[0] = 1;
+        }
+
+        //  An empty numerator or denominator is the empty set
+        muhash3072(const std::vector<uint8_t>& numerator_bytes, const std::vector<uint8_t>& denominator_bytes) {
+            numerator = from_bytes(numerator_bytes);
+            denominator = from_bytes(denominator_bytes);
+        }
+
+        void insert(const eosio::checksum256& digest) { multiply(numerator, to_element(digest)); }
+
+        void remove(const eosio::checksum256& digest) { multiply(denominator, to_element(digest)); }
+
+        std::vector<uint8_t> numerator_bytes() const { return to_bytes(numerator); }
+
+        std::vector<uint8_t> denominator_bytes() const { return to_bytes(denominator); }
+
+        //  sha256 of numerator / denominator, the same for every history that leads to the same set
+        eosio::checksum256 finalize() const {
+            auto result = numerator;
+            multiply(result, inverse(denominator));
+            auto bytes = to_bytes(result);
+            return eosio::sha256((const char*)bytes.data(), bytes.size());
+        }
+
+       private:
+        typedef std::array<uint32_t, NUM_LIMBS> num3072;
+
+        //  2^3072 - PRIME
+        static constexpr uint64_t PRIME_DIFF = 1103717;
+
+        num3072 numerator = {};
+        num3072 denominator = {};
+
+        static num3072 prime() {
+            num3072 p;
+            p.fill(0xffffffff);
+            p[0] = 0xffffffff - PRIME_DIFF + 1;
+            return p;
+        }
+
+        static bool is_one(const num3072& a) {
+            if (a[0] != 1) {
+                return false;
+            }
+            for (uint32_t i = 1; i < NUM_LIMBS; i++) {
+                if (a[i] != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool greater_or_equal(const num3072& a, const num3072& b) {
+            for (int i = NUM_LIMBS - 1; i >= 0; i--) {
+                if (a[i] != b[i]) {
+                    return a[i] > b[i];
+                }
+            }
+            return true;
+        }
+
+        //  a + b modulo 2^3072, returns the carry
+        static uint32_t add(num3072& a, const num3072& b) {
+            uint64_t carry = 0;
+            for (uint32_t i = 0; i < NUM_LIMBS; i++) {
+                carry += (uint64_t)a[i] + b[i];
+                a[i] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            return carry;
+        }
+
+        //  a - b modulo 2^3072
+        static void subtract(num3072& a, const num3072& b) {
+            uint64_t borrow = 0;
+            for (uint32_t i = 0; i < NUM_LIMBS; i++) {
+                auto diff = (uint64_t)a[i] - b[i] - borrow;
+                a[i] = (uint32_t)diff;
+                borrow = diff >> 63;
+            }
+        }
+
+        static void shift_right(num3072& a, const uint32_t top_bit) {
+            for (uint32_t i = 0; i + 1 < NUM_LIMBS; i++) {
+                a[i] = (a[i] >> 1) | (a[i + 1] << 31);
+            }
+            a[NUM_LIMBS - 1] = (a[NUM_LIMBS - 1] >> 1) | (top_bit << 31);
+        }
+
+        static void reduce(num3072& a) {
+            static const auto p = prime();
+            if (greater_or_equal(a, p)) {
+                subtract(a, p);
+            }
+        }
+
+        //  a / 2 modulo the prime
+        static void halve(num3072& a) {
+            static const auto p = prime();
+            uint32_t carry = 0;
+            if (a[0] & 1) {
+                carry = add(a, p);
+            }
+            shift_right(a, carry);
+        }
+
+        //  a - b modulo the prime
+        static void subtract_mod(num3072& a, const num3072& b) {
+            auto underflow = !greater_or_equal(a, b);
+            subtract(a, b);
+            if (underflow) {
+                // a - b + 2^3072 is larger than PRIME_DIFF, subtracting it yields a - b + prime
+                num3072 diff = {};
+                diff[0] = PRIME_DIFF;
+                subtract(a, diff);
+            }
+        }
+
+        //  a * b modulo the prime
+        static void multiply(num3072& a, const num3072& b) {
+            std::array<uint32_t, NUM_LIMBS * 2> product = {};
+            for (uint32_t i = 0; i < NUM_LIMBS; i++) {
+                uint64_t carry = 0;
+                for (uint32_t j = 0; j < NUM_LIMBS; j++) {
+                    carry += (uint64_t)a[i] * b[j] + product[i + j];
+                    product[i + j] = (uint32_t)carry;
+                    carry >>= 32;
+                }
+                product[i + NUM_LIMBS] = carry;
+            }
+
+            // 2^3072 is congruent to PRIME_DIFF
+            uint64_t carry = 0;
+            for (uint32_t i = 0; i < NUM_LIMBS; i++) {
+                carry += (uint64_t)product[i + NUM_LIMBS] * PRIME_DIFF + product[i];
+                a[i] = (uint32_t)carry;
+                carry >>= 32;
+            }
+            while (carry > 0) {
+                carry *= PRIME_DIFF;
+                for (uint32_t i = 0; i < NUM_LIMBS && carry > 0; i++) {
+                    carry += a[i];
+                    a[i] = (uint32_t)carry;
+                    carry >>= 32;
+                }
+            }
+            reduce(a);
+        }
+
+        //  binary extended euclidean algorithm, a must be a non-zero reduced number
+        static num3072 inverse(const num3072& a) {
+            num3072 u = a;
+            num3072 v = prime();
+            num3072 x1 = {};
+            num3072 x2 = {};
+            x1[0] = 1;
+            // invariants: x1 * a = u and x2 * a = v modulo the prime
+            while (!is_one(u) && !is_one(v)) {
+                while ((u[0] & 1) == 0) {
+                    shift_right(u, 0);
+                    halve(x1);
+                }
+                while ((v[0] & 1) == 0) {
+                    shift_right(v, 0);
+                    halve(x2);
+                }
+                if (greater_or_equal(u, v)) {
+                    subtract(u, v);
+                    subtract_mod(x1, x2);
+                } else {
+                    subtract(v, u);
+                    subtract_mod(x2, x1);
+                }
+            }
+            return is_one(u) ? x1 : x2;
+        }
+
+        //  the 384 bytes of sha256(digest || i) for i in 0..11, read as a little-endian number
+        static num3072 to_element(const eosio::checksum256& digest) {
+            std::array<uint8_t, 33> input;
+            auto digest_bytes = digest.extract_as_byte_array();
+            std::copy(digest_bytes.begin(), digest_bytes.end(), input.begin());
+
+            std::vector<uint8_t> bytes;
+            bytes.reserve(NUM_BYTES);
+            for (uint8_t i = 0; i < NUM_BYTES / 32; i++) {
+                input[32] = i;
+                auto block = eosio::sha256((const char*)input.data(), input.size()).extract_as_byte_array();
+                bytes.insert(bytes.end(), block.begin(), block.end());
+            }
+            auto element = from_bytes(bytes);
+            reduce(element);
+            return element;
+        }
+
+        static num3072 from_bytes(const std::vector<uint8_t>& bytes) {
+            num3072 a = {};
+            if (bytes.empty()) {
+                a[0] = 1;
+                return a;
+            }
+            eosio::check(bytes.size() == NUM_BYTES, "muhash3072: invalid number size");
+            for (uint32_t i = 0; i < NUM_LIMBS; i++) {
+                a[i] = (uint32_t)bytes[i * 4] | ((uint32_t)bytes[i * 4 + 1] << 8) | ((uint32_t)bytes[i * 4 + 2] << 16)
+                       | ((uint32_t)bytes[i * 4 + 3] << 24);
+            }
+            return a;
+        }
+
+        static std::vector<uint8_t> to_bytes(const num3072& a) {
+            std::vector<uint8_t> bytes(NUM_BYTES);
+            for (uint32_t i = 0; i < NUM_LIMBS; i++) {
+                bytes[i * 4] = a[i];
+                bytes[i * 4 + 1] = a[i] >> 8;
+                bytes[i * 4 + 2] = a[i] >> 16;
+                bytes[i * 4 + 3] = a[i] >> 24;
+            }
+            return bytes;
+        }
+    };
+}  // namespace xsat
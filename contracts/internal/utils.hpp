@@ -129,6 +129,80 @@ namespace xsat::utils {
         return height > GENESIS_ACTIVATION ? is_unspendable_genesis(script) : is_unspendable_legacy(script);
     }
 
+    //  Standard scripts are stored as a 1-byte template tag followed by the hash/program:
+    //  0x00 P2PKH, 0x01 P2SH, 0x02 P2WPKH, 0x03 P2WSH, 0x04 P2TR, 0xff raw script
+    static vector<uint8_t> compress_script(const vector<uint8_t>& script) {
+        const auto size = script.size();
+        uint8_t tag = 0xff;
+        uint32_t offset = 0;
+        uint32_t length = size;
+        if (size == 25 && script[0] == 0x76 && script[1] == 0xa9 && script[2] == 0x14 && script[23] == 0x88
+            && script[24] == 0xac) {
+            tag = 0x00, offset = 3, length = 20;
+        } else if (size == 23 && script[0] == 0xa9 && script[1] == 0x14 && script[22] == 0x87) {
+            tag = 0x01, offset = 2, length = 20;
+        } else if (size == 22 && script[0] == 0x00 && script[1] == 0x14) {
+            tag = 0x02, offset = 2, length = 20;
+        } else if (size == 34 && script[0] == 0x00 && script[1] == 0x20) {
+            tag = 0x03, offset = 2, length = 32;
+        } else if (size == 34 && script[0] == 0x51 && script[1] == 0x20) {
+            tag = 0x04, offset = 2, length = 32;
+        }
+        vector<uint8_t> result;
+        result.reserve(length + 1);
+        result.push_back(tag);
+        result.insert(result.end(), script.begin() + offset, script.begin() + offset + length);
+        return result;
+    }
+
+    static vector<uint8_t> decompress_script(const vector<uint8_t>& data) {
+        check(!data.empty(), "invalid compressed script");
+        const auto tag = data[0];
+        vector<uint8_t> result;
+        switch (tag) {
+            case 0x00:
+                result = {0x76, 0xa9, 0x14};
+                break;
+            case 0x01:
+                result = {0xa9, 0x14};
+                break;
+            case 0x02:
+                result = {0x00, 0x14};
+                break;
+            case 0x03:
+                result = {0x00, 0x20};
+                break;
+            case 0x04:
+                result = {0x51, 0x20};
+                break;
+            case 0xff:
+                break;
+            default:
+                check(false, "invalid compressed script");
+        }
+        result.insert(result.end(), data.begin() + 1, data.end());
+        if (tag == 0x00) {
+            result.push_back(0x88);
+            result.push_back(0xac);
+        } else if (tag == 0x01) {
+            result.push_back(0x87);
+        }
+        return result;
+    }
+
+    //  Digest of a single utxo as an element of the utxo set commitment
+    static checksum256 compute_utxo_digest(const checksum256& txid, const uint32_t index, const uint64_t value,
+                                           const vector<uint8_t>& scriptpubkey) {
+        std::vector<char> result;
+        result.resize(44 + scriptpubkey.size());
+        eosio::datastream<char*> ds(result.data(), result.size());
+        ds << txid;
+        ds << index;
+        ds << value;
+        ds.write((const char*)scriptpubkey.data(), scriptpubkey.size());
+        return eosio::sha256(result.data(), result.size());
+    }
+
     static std::vector<uint8_t> convert_bits(const std::vector<uint8_t>& in, int from_bits, int to_bits, bool pad) {
         int acc = 0;
         int bits = 0;
@@ -53,14 +53,18 @@ void pool::updateheight(const name& synchronizer, const uint64_t latest_produced
             row.donate_rate = 0;
             row.total_donated = asset{0, XSAT_SYMBOL};
         });
+        add_active(*synchronizer_itr);
     } else {
         if (synchronizer_itr->latest_produced_block_height >= latest_produced_block_height) {
             return;
         }
+        remove_active(*synchronizer_itr);
         _synchronizer.modify(synchronizer_itr, same_payer, [&](auto& row) {
             row.latest_produced_block_height = latest_produced_block_height;
         });
+        add_active(*synchronizer_itr);
     }
+    prune_active(latest_produced_block_height);
 
     save_miners(synchronizer, miners);
 
@@ -117,13 +121,16 @@ void pool::initpool(const name& synchronizer, const uint64_t latest_produced_blo
             row.total_donated = asset{0, XSAT_SYMBOL};
             row.memo = memo;
         });
+        add_active(*synchronizer_itr);
     } else {
         if (synchronizer_itr->latest_produced_block_height < latest_produced_block_height) {
+            remove_active(*synchronizer_itr);
             _synchronizer.modify(synchronizer_itr, same_payer, [&](auto& row) {
                 row.latest_produced_block_height = latest_produced_block_height;
                 row.reward_recipient = reward_recipient;
                 row.memo = memo;
             });
+            add_active(*synchronizer_itr);
         }
     }
     save_miners(synchronizer, miners);
@@ -142,6 +149,7 @@ void pool::delpool(const name& synchronizer) {
         = _synchronizer.require_find(synchronizer.value, "poolreg.xsat::delpool: [synchronizer] does not exists");
     check(synchronizer_itr->unclaimed.amount == 0,
           "poolreg.xsat::delpool: cannot erase synchronizer while unclaimed rewards exist");
+    remove_active(*synchronizer_itr);
     _synchronizer.erase(synchronizer_itr);
 
     // erase miners
@@ -175,9 +183,11 @@ void pool::config(const name& synchronizer, const uint16_t produced_block_limit)
     auto synchronizer_itr
         = _synchronizer.require_find(synchronizer.value, "poolreg.xsat::config: [synchronizer] does not exists");
 
+    remove_active(*synchronizer_itr);
     _synchronizer.modify(synchronizer_itr, same_payer, [&](auto& row) {
         row.produced_block_limit = produced_block_limit;
     });
+    add_active(*synchronizer_itr);
 }
 
 //@auth synchronizer
@@ -306,6 +316,22 @@ void pool::buyslot(const name& synchronizer, const name& receiver, const uint16_
     pay.send(0, ZERO_HASH, synchronizer, BUY_SLOT, num_slots);
 }
 
+//@auth get_self()
+[[eosio::action]]
+void pool::initactive() {
+    require_auth(get_self());
+
+    auto sync_expiry_itr = _sync_expiry.begin();
+    while (sync_expiry_itr != _sync_expiry.end()) {
+        sync_expiry_itr = _sync_expiry.erase(sync_expiry_itr);
+    }
+    _active_stat.set(active_stat_row{}, get_self());
+
+    for (auto synchronizer_itr = _synchronizer.begin(); synchronizer_itr != _synchronizer.end(); synchronizer_itr++) {
+        add_active(*synchronizer_itr);
+    }
+}
+
 [[eosio::on_notify("*::transfer")]]
 void pool::on_transfer(const name& from, const name& to, const asset& quantity, const string& memo) {
     // ignore transfers
@@ -347,6 +373,84 @@ void pool::save_miners(const name& synchronizer, const vector<string>& miners) {
     }
 }
 
+// Counters are only maintained once `initactive` has been run
+void pool::add_active(const synchronizer_row& synchronizer) {
+    if (!_active_stat.exists()) {
+        return;
+    }
+    auto active_stat = _active_stat.get();
+    if (synchronizer.produced_block_limit == 0) {
+        active_stat.num_unlimited++;
+        _active_stat.set(active_stat, get_self());
+        return;
+    }
+
+    // a synchronizer expiring below the pruned height is already inactive
+    const auto expiry_height = synchronizer.latest_produced_block_height + synchronizer.produced_block_limit;
+    if (expiry_height < active_stat.pruned_height) {
+        return;
+    }
+    auto sync_expiry_itr = _sync_expiry.find(expiry_height);
+    if (sync_expiry_itr == _sync_expiry.end()) {
+        _sync_expiry.emplace(get_self(), [&](auto& row) {
+            row.height = expiry_height;
+            row.num_synchronizers = 1;
+        });
+    } else {
+        _sync_expiry.modify(sync_expiry_itr, same_payer, [&](auto& row) {
+            row.num_synchronizers++;
+        });
+    }
+    active_stat.num_limited++;
+    _active_stat.set(active_stat, get_self());
+}
+
+void pool::remove_active(const synchronizer_row& synchronizer) {
+    if (!_active_stat.exists()) {
+        return;
+    }
+    auto active_stat = _active_stat.get();
+    if (synchronizer.produced_block_limit == 0) {
+        active_stat.num_unlimited--;
+        _active_stat.set(active_stat, get_self());
+        return;
+    }
+
+    // already removed when its expiry height was pruned
+    const auto expiry_height = synchronizer.latest_produced_block_height + synchronizer.produced_block_limit;
+    if (expiry_height < active_stat.pruned_height) {
+        return;
+    }
+    auto sync_expiry_itr = _sync_expiry.require_find(expiry_height, "poolreg.xsat: [syncexpiry] does not exists");
+    if (sync_expiry_itr->num_synchronizers == 1) {
+        _sync_expiry.erase(sync_expiry_itr);
+    } else {
+        _sync_expiry.modify(sync_expiry_itr, same_payer, [&](auto& row) {
+            row.num_synchronizers--;
+        });
+    }
+    active_stat.num_limited--;
+    _active_stat.set(active_stat, get_self());
+}
+
+// The head height is at least the latest produced block height, so synchronizers expiring below it are inactive
+void pool::prune_active(const uint64_t height) {
+    if (!_active_stat.exists()) {
+        return;
+    }
+    auto active_stat = _active_stat.get();
+    if (height <= active_stat.pruned_height) {
+        return;
+    }
+    auto sync_expiry_itr = _sync_expiry.begin();
+    while (sync_expiry_itr != _sync_expiry.end() && sync_expiry_itr->height < height) {
+        active_stat.num_limited -= sync_expiry_itr->num_synchronizers;
+        sync_expiry_itr = _sync_expiry.erase(sync_expiry_itr);
+    }
+    active_stat.pruned_height = height;
+    _active_stat.set(active_stat, get_self());
+}
+
 void pool::token_transfer(const name& from, const string& to, const extended_asset& value) {
     btc::transfer_action transfer(value.contract, {from, "active"_n});
 
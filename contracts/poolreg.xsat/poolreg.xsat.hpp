@@ -153,6 +153,59 @@ class [[eosio::contract("poolreg.xsat")]] pool : public contract {
     };
     typedef eosio::singleton<"stat"_n, stat_row> stat_table;
 
+    /**
+     * ## TABLE `activestat`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} num_unlimited` - number of synchronizers without a produced block limit
+     * - `{uint64_t} num_limited` - number of synchronizers counted in `syncexpiry`
+     * - `{uint64_t} pruned_height` - `syncexpiry` rows below this height have been removed
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "num_unlimited": 1,
+     *   "num_limited": 20,
+     *   "pruned_height": 840000
+     * }
+     * ```
+     */
+    struct [[eosio::table]] active_stat_row {
+        uint64_t num_unlimited;
+        uint64_t num_limited;
+        uint64_t pruned_height;
+    };
+    typedef eosio::singleton<"activestat"_n, active_stat_row> active_stat_table;
+
+    /**
+     * ## TABLE `syncexpiry`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} height` - the last head height at which the synchronizers are still active,
+     *   `latest_produced_block_height + produced_block_limit`
+     * - `{uint64_t} num_synchronizers` - number of synchronizers expiring at this height
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "height": 840432,
+     *   "num_synchronizers": 2
+     * }
+     * ```
+     */
+    struct [[eosio::table]] sync_expiry_row {
+        uint64_t height;
+        uint64_t num_synchronizers;
+        uint64_t primary_key() const { return height; }
+    };
+    typedef eosio::multi_index<"syncexpiry"_n, sync_expiry_row> sync_expiry_table;
+
     /**
      * ## ACTION `setdonateacc`
      *
@@ -365,6 +418,23 @@ class [[eosio::contract("poolreg.xsat")]] pool : public contract {
     [[eosio::action]]
     void claim(const name& synchronizer);
 
+    /**
+     * ## ACTION `initactive`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Rebuild the active synchronizer counters from the synchronizer table.
+     * > The counters are then maintained as synchronizers produce blocks or change their limit.
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action poolreg.xsat initactive '[]' -p poolreg.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void initactive();
+
     [[eosio::on_notify("*::transfer")]]
     void on_transfer(const name& from, const name& to, const asset& quantity, const string& memo);
 
@@ -403,14 +473,40 @@ class [[eosio::contract("poolreg.xsat")]] pool : public contract {
     using delpoollog_action = eosio::action_wrapper<"delpoollog"_n, &pool::delpoollog>;
     using setdonatelog_action = eosio::action_wrapper<"setdonatelog"_n, &pool::setdonatelog>;
 
+    // A synchronizer is active while head_height <= latest_produced_block_height + produced_block_limit.
+    // Returns nullopt until the counters are initialized by `initactive`.
+    static optional<uint64_t> get_num_active_synchronizers(const uint64_t head_height) {
+        active_stat_table _active_stat(POOL_REGISTER_CONTRACT, POOL_REGISTER_CONTRACT.value);
+        if (!_active_stat.exists()) {
+            return std::nullopt;
+        }
+        auto active_stat = _active_stat.get();
+        uint64_t num_active = active_stat.num_unlimited + active_stat.num_limited;
+
+        // only the rows expired since the last prune are visited
+        sync_expiry_table _sync_expiry(POOL_REGISTER_CONTRACT, POOL_REGISTER_CONTRACT.value);
+        for (auto itr = _sync_expiry.begin(); itr != _sync_expiry.end() && itr->height < head_height; itr++) {
+            num_active -= itr->num_synchronizers;
+        }
+        return num_active;
+    }
+
    private:
     synchronizer_table _synchronizer = synchronizer_table(_self, _self.value);
     miner_table _miner = miner_table(_self, _self.value);
     config_table _config = config_table(_self, _self.value);
     stat_table _stat = stat_table(_self, _self.value);
+    active_stat_table _active_stat = active_stat_table(_self, _self.value);
+    sync_expiry_table _sync_expiry = sync_expiry_table(_self, _self.value);
 
     void save_miners(const name& synchronizer, const vector<string>& miners);
 
+    void add_active(const synchronizer_row& synchronizer);
+
+    void remove_active(const synchronizer_row& synchronizer);
+
+    void prune_active(const uint64_t height);
+
     void token_transfer(const name& from, const string& to, const extended_asset& value);
 
     void token_transfer(const name& from, const name& to, const extended_asset& value, const string& memo);
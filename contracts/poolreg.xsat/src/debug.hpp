@@ -16,6 +16,10 @@ void pool::cleartable(const name table_name, const optional<name> scope, const o
         clear_table(_synchronizer, rows_to_clear);
     else if (table_name == "miners"_n)
         clear_table(_miner, rows_to_clear);
+    else if (table_name == "syncexpiry"_n)
+        clear_table(_sync_expiry, rows_to_clear);
+    else if (table_name == "activestat"_n)
+        _active_stat.remove();
     else
         check(false, "poolreg.xsat::cleartable: [table_name] unknown table to clear");
 }
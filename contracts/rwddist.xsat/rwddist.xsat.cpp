@@ -123,10 +123,11 @@ void reward_distribution::distribute_per_symbol(const ChainStateRow& chain_state
 
     uint64_t endorsed_staking = 0;
     uint64_t reached_consensus_staking = 0;
+    const auto endorsed_validators = block_endorse::get_provider_validators(*endorsement_itr);
     vector<validator_info> provider_validators;
-    provider_validators.reserve(endorsement_itr->provider_validators.size());
-    for (size_t i = 0; i < endorsement_itr->provider_validators.size(); ++i) {
-        const auto validator = endorsement_itr->provider_validators[i];
+    provider_validators.reserve(endorsed_validators.size());
+    for (size_t i = 0; i < endorsed_validators.size(); ++i) {
+        const auto validator = endorsed_validators[i];
         provider_validators.emplace_back(
             validator_info{.account = validator.account, .staking = validator.staking, .created_at = validator.created_at});
 
@@ -136,6 +137,11 @@ void reward_distribution::distribute_per_symbol(const ChainStateRow& chain_state
         }
     }
 
+    // bitmap records are not in endorsement order, the stake at consensus is tracked while voting
+    if (endorsement_itr->votes.has_value() && is_btc) {
+        reached_consensus_staking = endorsement_itr->votes.value().consensus_staking;
+    }
+
     auto reward_log_itr = _reward_log.emplace(get_self(), [&](auto& row) {
         row.height = height;
         row.hash = hash;
@@ -289,7 +295,9 @@ void reward_distribution::token_transfer(const name& from, const name& to, const
 
 [[eosio::action]]
 void reward_distribution::delrewardlog(const uint64_t start_height, const uint64_t end_height) {
-    require_auth(get_self());
+    if (!has_auth(UTXO_MANAGE_CONTRACT)) {
+        require_auth(get_self());
+    }
 
     check(start_height <= end_height, "rwddist.xsat::delrewardlog: start_height must be less than or equal to end_height");
 
@@ -259,6 +259,7 @@ class [[eosio::contract("rwddist.xsat")]] reward_distribution : public contract
     using endtreward2_action = eosio::action_wrapper<"endtreward2"_n, &reward_distribution::endtreward2>;
     using rewardlog_action = eosio::action_wrapper<"rewardlog"_n, &reward_distribution::rewardlog>;
     using endtrwdlog_action = eosio::action_wrapper<"endtrwdlog"_n, &reward_distribution::endtrwdlog>;
+    using delrewardlog_action = eosio::action_wrapper<"delrewardlog"_n, &reward_distribution::delrewardlog>;
 
    private:
     // init table
@@ -14,20 +14,61 @@ void utxo_manage::cleartable(const name table_name, const optional<uint64_t> sco
 
     if (table_name == "utxos"_n)
         clear_table(_utxo, rows_to_clear);
+    else if (table_name == "balances"_n)
+        clear_table(_balance, rows_to_clear);
+    else if (table_name == "backfill"_n)
+        _backfill.remove();
     else if (table_name == "pendingutxos"_n)
         clear_table(_pending_utxo, rows_to_clear);
     else if (table_name == "spentutxos"_n)
         clear_table(_spent_utxo, rows_to_clear);
+    else if (table_name == "spentlog"_n) {
+        spent_log_table _spent_log(get_self(), value);
+        clear_table(_spent_log, rows_to_clear);
+    } else if (table_name == "parseshards"_n) {
+        parse_shard_table _parse_shard(get_self(), value);
+        clear_table(_parse_shard, rows_to_clear);
+    } else if (table_name == "parsesplit"_n) {
+        parse_split_table _parse_split(get_self(), value);
+        _parse_split.remove();
+    } else if (table_name == "parsingblks"_n)
+        clear_table(_parsing_block, rows_to_clear);
+    else if (table_name == "specparsing"_n)
+        clear_table(_spec_parsing, rows_to_clear);
+    else if (table_name == "spentstate"_n)
+        _spent_state.remove();
+    else if (table_name == "utxoset"_n)
+        _utxo_set.remove();
+    else if (table_name == "forkprune"_n)
+        _fork_prune.remove();
+    else if (table_name == "gcconfig"_n)
+        _gc_config.remove();
+    else if (table_name == "gcstate"_n)
+        _gc_state.remove();
+    else if (table_name == "coldtier"_n)
+        _cold_tier.remove();
+    else if (table_name == "coldutxos"_n)
+        clear_table(_cold_utxo, rows_to_clear);
+    else if (table_name == "timelines"_n)
+        clear_table(_block_timeline, rows_to_clear);
+    else if (table_name == "pipestats"_n)
+        _pipeline_stats.remove();
     else if (table_name == "blocks"_n)
         clear_table(_block, rows_to_clear);
+    else if (table_name == "headers"_n)
+        clear_table(_header_chunk, rows_to_clear);
     else if (table_name == "block.extra"_n)
         clear_table(_block_extra, rows_to_clear);
     else if (table_name == "consensusblk"_n)
         clear_table(_consensus_block, rows_to_clear);
     else if (table_name == "chainstate"_n)
         _chain_state.remove();
+    else if (table_name == "chaincursor"_n)
+        _chain_cursor.remove();
     else if (table_name == "config"_n)
         _config.remove();
+    else if (table_name == "workcost"_n)
+        _work_cost.remove();
     else
         check(false, "utxomng.xsat::cleartable: [table_name] unknown table to clear");
 }
@@ -61,9 +102,9 @@ bool utxo_manage::isvalid(const string& btc_address) {
 [[eosio::action]]
 void utxo_manage::setirrhash(const checksum256& irreversible_hash) {
     require_auth(get_self());
-    auto chain_state = _chain_state.get();
+    auto chain_state = get_chain_state();
     chain_state.irreversible_hash = irreversible_hash;
-    _chain_state.set(chain_state, get_self());
+    save_chain_state(chain_state);
 }
 
 [[eosio::action]]
@@ -82,7 +123,7 @@ void utxo_manage::resetpending(uint64_t row) {
         pending_utxo_itr = _pending_utxo.erase(pending_utxo_itr);
     }
     if (pending_utxo_itr == pending_utxo_end) {
-        auto chain_state = _chain_state.get();
+        auto chain_state = get_chain_state();
         auto config = _config.get();
         auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
         auto consensus_block_itr = consensus_block_idx.lower_bound(chain_state.irreversible_height + 1);
@@ -91,14 +132,15 @@ void utxo_manage::resetpending(uint64_t row) {
         chain_state.parsed_height = chain_state.irreversible_height;
         chain_state.parsing_height = chain_state.irreversible_height + 1;
         while (consensus_block_itr != consensus_end) {
-            chain_state.parsing_progress_of[consensus_block_itr->hash]
-                = {.bucket_id = consensus_block_itr->bucket_id,
-                   .parser = consensus_block_itr->synchronizer,
-                   .parse_expiration_time = current_time_point() + eosio::seconds(config.parse_timeout_seconds)};
+            save_parsing_block(consensus_block_itr->height, consensus_block_itr->hash,
+                               {.bucket_id = consensus_block_itr->bucket_id,
+                                .parser = consensus_block_itr->synchronizer,
+                                .parse_expiration_time
+                                = current_time_point() + eosio::seconds(config.parse_timeout_seconds)});
             consensus_block_itr++;
         }
         chain_state.status = waiting;
-        _chain_state.set(chain_state, get_self());
+        save_chain_state(chain_state);
     }
 }
 
@@ -179,4 +221,4 @@ void utxo_manage::addconsesblk(const uint64_t bucket_id, const uint64_t height,
             row.created_at = created_at;
         });
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
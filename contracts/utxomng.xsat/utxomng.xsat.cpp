@@ -2,6 +2,7 @@
 #include <blksync.xsat/blksync.xsat.hpp>
 #include <blkendt.xsat/blkendt.xsat.hpp>
 #include <rwddist.xsat/rwddist.xsat.hpp>
+#include <gasfund.xsat/gasfund.xsat.hpp>
 #include <rescmng.xsat/rescmng.xsat.hpp>
 #include <poolreg.xsat/poolreg.xsat.hpp>
 #include <bitcoin/core/block_header.hpp>
@@ -23,13 +24,13 @@ void utxo_manage::init(const uint64_t height, const checksum256& hash, const che
     check(hash > ZERO_HASH, "utxomng.xsat::init: invalid hash");
     check(cumulative_work > ZERO_HASH, "utxomng.xsat::init: invalid cumulative_work");
 
-    auto chain_state = _chain_state.get_or_default();
+    auto chain_state = get_chain_state();
     chain_state.head_height = height;
     chain_state.irreversible_height = height;
     chain_state.irreversible_hash = hash;
     chain_state.parsed_height = height;
     chain_state.status = waiting;
-    _chain_state.set(chain_state, get_self());
+    save_chain_state(chain_state);
 }
 
 //@auth get_self()
@@ -55,6 +56,75 @@ void utxo_manage::config(const uint16_t parse_timeout_seconds, const uint16_t nu
     _config.set(config, get_self());
 }
 
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::setworkcost(const uint64_t budget, const uint32_t pending_emplace, const uint32_t remove_utxo,
+                              const uint32_t save_utxo, const uint32_t save_spent_utxo, const uint32_t pending_erase,
+                              const uint32_t deserialize_kbytes) {
+    require_auth(get_self());
+
+    check(pending_emplace > 0, "utxomng.xsat::setworkcost: pending_emplace must be greater than 0");
+    check(pending_erase > 0, "utxomng.xsat::setworkcost: pending_erase must be greater than 0");
+
+    auto work_cost = _work_cost.get_or_default();
+    work_cost.budget = budget;
+    work_cost.pending_emplace = pending_emplace;
+    work_cost.remove_utxo = remove_utxo;
+    work_cost.save_utxo = save_utxo;
+    work_cost.save_spent_utxo = save_spent_utxo;
+    work_cost.pending_erase = pending_erase;
+    work_cost.deserialize_kbytes = deserialize_kbytes;
+    _work_cost.set(work_cost, get_self());
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::setshardsize(const uint32_t num_txs_per_shard) {
+    require_auth(get_self());
+
+    auto config = _config.get_or_default();
+    config.num_txs_per_shard = num_txs_per_shard;
+    _config.set(config, get_self());
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::setgcconfig(const uint64_t retained_reward_log_blocks, const uint64_t retained_distribution_blocks,
+                              const uint16_t max_actions, const uint64_t max_rows) {
+    require_auth(get_self());
+    check(max_rows > 0, "utxomng.xsat::setgcconfig: max_rows must be greater than 0");
+
+    auto gc_config = _gc_config.get_or_default();
+    gc_config.retained_reward_log_blocks = retained_reward_log_blocks;
+    gc_config.retained_distribution_blocks = retained_distribution_blocks;
+    gc_config.max_actions = max_actions;
+    gc_config.max_rows = max_rows;
+    _gc_config.set(gc_config, get_self());
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::setcoldtier(const uint64_t retained_hot_utxos, const uint32_t max_frozen_utxos) {
+    require_auth(get_self());
+    check(max_frozen_utxos > 0, "utxomng.xsat::setcoldtier: max_frozen_utxos must be greater than 0");
+
+    auto cold_tier = _cold_tier.get_or_default();
+    cold_tier.retained_hot_utxos = retained_hot_utxos;
+    cold_tier.max_frozen_utxos = max_frozen_utxos;
+    _cold_tier.set(cold_tier, get_self());
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::initbackfill() {
+    require_auth(get_self());
+    check(!_backfill.exists(), "utxomng.xsat::initbackfill: backfill has already been initialized");
+
+    // every utxo saved from now on gets an id of at least `end_id`
+    auto end_id = _utxo.available_primary_key();
+    _backfill.set({.end_id = end_id, .next_id = 0, .completed = _utxo.begin() == _utxo.end()}, get_self());
+}
+
 //@auth get_self()
 [[eosio::action]]
 void utxo_manage::addutxo(const uint64_t id, const checksum256& txid, const uint32_t index,
@@ -64,6 +134,7 @@ void utxo_manage::addutxo(const uint64_t id, const checksum256& txid, const uint
     auto chain_state = _chain_state.get_or_default();
     check(chain_state.head_height <= START_HEIGHT, "utxomng.xsat::addutxo: height must be less than or equal to 839999");
 
+    auto utxo_set_hash = get_utxo_set_hash();
     auto utxo_idx = _utxo.get_index<"byutxoid"_n>();
     auto utxo_itr = utxo_idx.find(xsat::utils::compute_utxo_id(txid, index));
     if (utxo_itr == utxo_idx.end()) {
@@ -74,14 +145,77 @@ void utxo_manage::addutxo(const uint64_t id, const checksum256& txid, const uint
             row.scriptpubkey = scriptpubkey;
             row.value = value;
         });
-        chain_state.num_utxos += 1;
-        _chain_state.set(chain_state, get_self());
+        if (is_backfilled(id)) {
+            add_balance(scriptpubkey, value);
+            utxo_set_hash.insert(xsat::utils::compute_utxo_digest(txid, index, value, scriptpubkey));
+        }
+        auto chain_cursor = get_chain_cursor(chain_state);
+        chain_cursor.num_utxos += 1;
+        save_chain_cursor(chain_cursor);
     } else {
+        auto backfilled = is_backfilled(utxo_itr->id);
+        if (backfilled) {
+            sub_balance(utxo_itr->scriptpubkey, utxo_itr->value);
+            utxo_set_hash.remove(
+                xsat::utils::compute_utxo_digest(txid, index, utxo_itr->value, utxo_itr->scriptpubkey));
+        }
         utxo_idx.modify(utxo_itr, same_payer, [&](auto& row) {
             row.scriptpubkey = scriptpubkey;
             row.value = value;
         });
+        if (backfilled) {
+            add_balance(scriptpubkey, value);
+            utxo_set_hash.insert(xsat::utils::compute_utxo_digest(txid, index, value, scriptpubkey));
+        }
     }
+    save_utxo_set_hash(utxo_set_hash);
+}
+
+//@auth get_self()
+[[eosio::action]]
+void utxo_manage::importutxos(const uint64_t start_id, const vector<uint8_t>& data,
+                              const checksum256& batch_commitment) {
+    require_auth(get_self());
+
+    auto chain_state = _chain_state.get_or_default();
+    check(chain_state.head_height <= START_HEIGHT,
+          "utxomng.xsat::importutxos: height must be less than or equal to 839999");
+
+    auto utxo_set_hash = get_utxo_set_hash();
+    auto utxo_idx = _utxo.get_index<"byutxoid"_n>();
+    xsat::muhash3072 batch_hash;
+    auto id = start_id;
+    eosio::datastream<const char*> ds((const char*)data.data(), data.size());
+    while (ds.remaining()) {
+        checksum256 txid;
+        uint32_t index;
+        uint64_t value;
+        std::vector<uint8_t> scriptpubkey;
+        ds >> txid >> index >> value >> scriptpubkey;
+
+        check(utxo_idx.find(xsat::utils::compute_utxo_id(txid, index)) == utxo_idx.end(),
+              "utxomng.xsat::importutxos: [utxos] already exists");
+        auto utxo_id = id++;
+        _utxo.emplace(get_self(), [&](auto& row) {
+            row.id = utxo_id;
+            row.txid = txid;
+            row.index = index;
+            row.scriptpubkey = scriptpubkey;
+            row.value = value;
+        });
+        auto digest = xsat::utils::compute_utxo_digest(txid, index, value, scriptpubkey);
+        batch_hash.insert(digest);
+        if (is_backfilled(utxo_id)) {
+            add_balance(scriptpubkey, value);
+            utxo_set_hash.insert(digest);
+        }
+    }
+    check(batch_hash.finalize() == batch_commitment, "utxomng.xsat::importutxos: batch commitment mismatch");
+
+    auto chain_cursor = get_chain_cursor(chain_state);
+    chain_cursor.num_utxos += id - start_id;
+    save_chain_cursor(chain_cursor);
+    save_utxo_set_hash(utxo_set_hash);
 }
 
 //@auth get_self()
@@ -93,10 +227,17 @@ void utxo_manage::delutxo(const uint64_t id) {
     check(chain_state.head_height <= START_HEIGHT, "utxomng.xsat::delutxo: height must be less than or equal to 839999");
 
     auto& utxo = _utxo.get(id, "utxomng.xsat::delutxo: [utxos] does not exist");
+    if (is_backfilled(utxo.id)) {
+        sub_balance(utxo.scriptpubkey, utxo.value);
+        auto utxo_set_hash = get_utxo_set_hash();
+        utxo_set_hash.remove(xsat::utils::compute_utxo_digest(utxo.txid, utxo.index, utxo.value, utxo.scriptpubkey));
+        save_utxo_set_hash(utxo_set_hash);
+    }
     _utxo.erase(utxo);
 
-    chain_state.num_utxos -= 1;
-    _chain_state.set(chain_state, get_self());
+    auto chain_cursor = get_chain_cursor(chain_state);
+    chain_cursor.num_utxos -= 1;
+    save_chain_cursor(chain_cursor);
 }
 
 //@auth get_self()
@@ -160,9 +301,14 @@ void utxo_manage::delspentutxo(uint64_t rows, const uint64_t nonce) {
     auto spent_utxo_itr = spent_utxo_idx.lower_bound(START_HEIGHT);
     auto spent_utxo_end = spent_utxo_idx.upper_bound(last_height);
 
-    while (spent_utxo_itr != spent_utxo_end && rows--) {
+    work_budget budget = {.remaining = rows};
+    while (spent_utxo_itr != spent_utxo_end && budget.available()) {
         spent_utxo_itr = spent_utxo_idx.erase(spent_utxo_itr);
+        budget.consume(1);
     }
+
+    // reclaim expired spent log scopes
+    prune_spent_log(last_height, 1, budget);
 }
 
 //@auth get_self()
@@ -194,6 +340,27 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
         require_auth(BLOCK_ENDORSE_CONTRACT);
     }
 
+    apply_consensus(height, hash, false);
+}
+
+//@auth blkendt.xsat
+[[eosio::action]]
+void utxo_manage::qconsensus(const uint64_t height, const checksum256& hash, const quorum_proof& proof) {
+    require_auth(BLOCK_ENDORSE_CONTRACT);
+
+    // blkendt.xsat only hands over a proof once every active scope reached quorum
+    check(proof.btc.num_providers > 0
+              && proof.btc.num_providers >= xsat::utils::num_reached_consensus(proof.btc.num_validators),
+          "4017:utxomng.xsat::qconsensus: btc endorsement has not reached consensus");
+    check(!proof.xsat.has_value()
+              || (proof.xsat->num_providers > 0
+                  && proof.xsat->num_providers >= xsat::utils::num_reached_consensus(proof.xsat->num_validators)),
+          "4017:utxomng.xsat::qconsensus: xsat endorsement has not reached consensus");
+
+    apply_consensus(height, hash, true);
+}
+
+void utxo_manage::apply_consensus(const uint64_t height, const checksum256& hash, const bool quorum_verified) {
     block_sync::passed_index_table _passed_index(BLOCK_SYNC_CONTRACT, height);
     auto passed_index_idx = _passed_index.get_index<"byhash"_n>();
     auto passed_index_itr = passed_index_idx.find(hash);
@@ -202,8 +369,8 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
         return;
     }
 
-    // Check whether consensus has been reached based on endorsement data.
-    if (!is_endorsement_consensus_reached(height, hash)) {
+    // Check whether consensus has been reached based on endorsement data, unless blkendt.xsat already did.
+    if (!quorum_verified && !is_endorsement_consensus_reached(height, hash)) {
         return;
     }
 
@@ -250,7 +417,7 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
         row.created_at = current_time_point();
     });
 
-    auto chain_state = _chain_state.get_or_default();
+    auto chain_state = get_chain_state();
     // Set latest block height
     if (chain_state.head_height < height) {
         chain_state.head_height = height;
@@ -260,23 +427,138 @@ void utxo_manage::consensus(const uint64_t height, const checksum256& hash) {
     auto config = _config.get();
     if (chain_state.parsing_height == height) {
         chain_state.parsing_height = height;
-        chain_state.parsing_progress_of[hash]
-            = {.bucket_id = passed_index_itr->bucket_id,
-               .parser = passed_index_itr->synchronizer,
-               .parse_expiration_time = current_time_point() + eosio::seconds(config.parse_timeout_seconds)};
+        save_parsing_block(height, hash,
+                           new_parsing_progress(height, hash, passed_index_itr->bucket_id,
+                                                passed_index_itr->synchronizer, config.parse_timeout_seconds));
     } else {
         find_set_next_parsable_block(chain_state, config.parse_timeout_seconds);
     }
 
     // Set the block height of the latest migration
     find_set_next_irreversible_block(chain_state);
-    _chain_state.set(chain_state, get_self());
+    save_chain_state(chain_state);
 
     // consensus
     block_sync::consensus_action block_sync_consensus(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n});
     block_sync_consensus.send(height, passed_index_itr->synchronizer, passed_index_itr->bucket_id);
 }
 
+//@auth blksync.xsat or blkendt.xsat
+[[eosio::action]]
+void utxo_manage::recordstage(const uint64_t height, const checksum256& hash, const pipeline_stage stage) {
+    if (!has_auth(BLOCK_SYNC_CONTRACT)) {
+        require_auth(BLOCK_ENDORSE_CONTRACT);
+    }
+    check(stage < NUM_PIPELINE_STAGES, "utxomng.xsat::recordstage: invalid stage");
+
+    record_stage(height, hash, stage);
+}
+
+[[eosio::action, eosio::read_only]]
+utxo_manage::utxo_page utxo_manage::utxosbyscrpt(const std::vector<uint8_t>& scriptpubkey, const uint64_t cursor,
+                                                 const uint16_t limit) {
+    check(limit > 0 && limit <= MAX_UTXO_QUERY_ROWS,
+          "4014:utxomng.xsat::utxosbyscrpt: limit must be between 1 and " + std::to_string(MAX_UTXO_QUERY_ROWS));
+
+    // Utxos of the same script are ordered by id within the index
+    auto utxo_idx = _utxo.get_index<"scriptpubkey"_n>();
+    auto utxo_itr = utxo_idx.lower_bound(xsat::utils::hash(scriptpubkey));
+    if (cursor > 0) {
+        auto cursor_itr = _utxo.find(cursor);
+        if (cursor_itr != _utxo.end() && cursor_itr->scriptpubkey == scriptpubkey) {
+            utxo_itr = utxo_idx.iterator_to(*cursor_itr);
+        } else {
+            // the cursor utxo has been spent since the previous page
+            while (utxo_itr != utxo_idx.end() && utxo_itr->scriptpubkey == scriptpubkey && utxo_itr->id < cursor) {
+                utxo_itr++;
+            }
+        }
+    }
+
+    // cold utxos are only bucketed by txid, so they cannot be listed by script and are only counted by its balance
+    auto balance_idx = _balance.get_index<"scripthash"_n>();
+    auto balance_itr = balance_idx.find(xsat::utils::hash(scriptpubkey));
+    auto cold_omitted = balance_itr != balance_idx.end() && balance_itr->num_cold_utxos.value_or(0) > 0;
+    utxo_page page{.next_cursor = 0, .cold_omitted = cold_omitted};
+    while (utxo_itr != utxo_idx.end() && utxo_itr->scriptpubkey == scriptpubkey) {
+        if (page.utxos.size() == limit) {
+            page.next_cursor = utxo_itr->id;
+            break;
+        }
+        page.utxos.push_back(*utxo_itr);
+        utxo_itr++;
+    }
+    return page;
+}
+
+[[eosio::action, eosio::read_only]]
+utxo_manage::utxo_page utxo_manage::utxosbyaddr(const string& address, const uint64_t cursor, const uint16_t limit) {
+    return utxosbyscrpt(address_to_script(address), cursor, limit);
+}
+
+[[eosio::action, eosio::read_only]]
+std::vector<utxo_manage::utxo_row> utxo_manage::getoutpoints(const std::vector<outpoint>& outpoints) {
+    check(outpoints.size() <= MAX_UTXO_QUERY_ROWS,
+          "4014:utxomng.xsat::getoutpoints: at most " + std::to_string(MAX_UTXO_QUERY_ROWS) + " outpoints per call");
+
+    std::vector<utxo_row> utxos;
+    auto utxo_idx = _utxo.get_index<"byutxoid"_n>();
+    for (const auto& outpoint : outpoints) {
+        auto utxo_itr = utxo_idx.find(xsat::utils::compute_utxo_id(outpoint.txid, outpoint.index));
+        if (utxo_itr != utxo_idx.end()) {
+            utxos.push_back(*utxo_itr);
+            continue;
+        }
+        auto cold_utxo = find_cold_utxo(outpoint.txid, outpoint.index);
+        if (cold_utxo.has_value()) {
+            utxos.push_back(*cold_utxo);
+        }
+    }
+    return utxos;
+}
+
+[[eosio::action, eosio::read_only]]
+utxo_manage::balance_row utxo_manage::getbalance(const string& address) {
+    check(_backfill.get_or_default().completed, "4018:utxomng.xsat::getbalance: balances are still being backfilled");
+
+    auto scripthash = xsat::utils::hash(address_to_script(address));
+    auto balance_idx = _balance.get_index<"scripthash"_n>();
+    auto balance_itr = balance_idx.find(scripthash);
+    if (balance_itr == balance_idx.end()) {
+        return {.scripthash = scripthash};
+    }
+    return *balance_itr;
+}
+
+[[eosio::action, eosio::read_only]]
+utxo_manage::tx_proof utxo_manage::gettxproof(const uint64_t height, const checksum256& txid) {
+    // The irreversible block keeps its data for num_retain_data_blocks, blocks that reached consensus until then
+    auto block_extra_itr = _block_extra.find(height);
+    if (block_extra_itr != _block_extra.end()) {
+        auto block = get_irreversible_block(height);
+        if (block.has_value()) {
+            auto proof = generate_tx_proof(block_extra_itr->bucket_id, block->hash, block->merkle, txid);
+            check(proof.has_value(), "4016:utxomng.xsat::gettxproof: transaction does not exist in the block");
+            return *proof;
+        }
+    }
+
+    auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
+    auto consensus_block_itr = consensus_block_idx.lower_bound(height);
+    auto consensus_block_end = consensus_block_idx.upper_bound(height);
+    check(consensus_block_itr != consensus_block_end,
+          "4015:utxomng.xsat::gettxproof: the block data is not retained");
+    for (; consensus_block_itr != consensus_block_end; consensus_block_itr++) {
+        auto proof = generate_tx_proof(consensus_block_itr->bucket_id, consensus_block_itr->hash,
+                                       consensus_block_itr->merkle, txid);
+        if (proof.has_value()) {
+            return *proof;
+        }
+    }
+    check(false, "4016:utxomng.xsat::gettxproof: transaction does not exist in the block");
+    return {};
+}
+
 //---------------------------------------------------------------------
 // Helper function: Check if endorsement consensus is reached
 //---------------------------------------------------------------------
@@ -316,27 +598,261 @@ utxo_manage::process_block_result utxo_manage::processblock(const name& synchron
                                                             const uint64_t nonce) {
     require_auth(synchronizer);
 
-    auto chain_state = _chain_state.get();
+    auto work_cost = _work_cost.get_or_default();
+    auto budget = get_work_budget(work_cost, process_row);
+    auto config = _config.get();
+    auto chain_state = get_chain_state();
+    migrate_legacy_progress(chain_state);
+
+    // Once every block has been parsed, or the next one has been parsed by `parseblock`, the irreversible block is
+    // migrated on its own
+    if (chain_state.parsing_height == 0 && chain_state.migrating_height > 0) {
+        pool::synchronizer_table _synchronizer(POOL_REGISTER_CONTRACT, POOL_REGISTER_CONTRACT.value);
+        _synchronizer.require_find(synchronizer.value, "4005:utxomng.xsat::processblock: only synchronizers can parse");
+
+        auto height = chain_state.migrating_height;
+        auto hash = chain_state.migrating_hash;
+
+        // fee deduction
+        resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
+        pay.send(height, hash, synchronizer, PARSE, 1);
+
+        if (chain_state.status == waiting) {
+            start_migration(chain_state);
+        }
+        process_irreversible_block(chain_state, config, work_cost, budget);
+        prune_forks(chain_state, work_cost, budget);
+        collect_garbage(chain_state, config, work_cost, budget);
+        backfill_utxos(work_cost, budget);
+        freeze_utxos(work_cost, budget);
+        save_chain_state(chain_state);
+        return {.status = get_parsing_status_name(chain_state.status), .height = height, .block_hash = hash};
+    }
+
     auto height = chain_state.parsing_height;
     check(height > 0, "4001:utxomng.xsat::processblock: there are currently no block to parse");
 
+    auto hash = claim_parsing_block(height, synchronizer, config.parse_timeout_seconds);
+
+    // Migrate irreversible block data first and then parse the latest block
+    if (chain_state.status == waiting) {
+        if (chain_state.migrating_height > 0) {
+            start_migration(chain_state);
+        } else {
+            chain_state.status = parsing;
+        }
+    }
+
+    auto parse_completed = false;
+    if (is_migration_phase(chain_state.status)) {
+        process_irreversible_block(chain_state, config, work_cost, budget);
+    } else if (chain_state.status == parsing) {
+        parse_completed = parse_block(chain_state, hash, synchronizer, config, work_cost, budget);
+    }
+
+    // Spend what is left of the budget on losing forks, expired data, unindexed utxos and dormant utxos
+    prune_forks(chain_state, work_cost, budget);
+    collect_garbage(chain_state, config, work_cost, budget);
+    backfill_utxos(work_cost, budget);
+    freeze_utxos(work_cost, budget);
+
+    // save state
+    save_chain_state(chain_state);
+
+    auto status = parse_completed ? "parsing_completed" : get_parsing_status_name(chain_state.status);
+    return {.status = status, .height = height, .block_hash = hash};
+}
+
+//@auth
+[[eosio::action]]
+utxo_manage::process_block_result utxo_manage::parseblock(const name& synchronizer, uint64_t process_row,
+                                                          const uint64_t nonce) {
+    require_auth(synchronizer);
+
+    auto work_cost = _work_cost.get_or_default();
+    auto budget = get_work_budget(work_cost, process_row);
+    auto config = _config.get();
+    auto chain_state = get_chain_state();
+    auto legacy_migrated = migrate_legacy_progress(chain_state);
+
+    auto height = chain_state.parsing_height;
+    check(height > 0, "4001:utxomng.xsat::parseblock: there are currently no block to parse");
+
+    auto hash = claim_parsing_block(height, synchronizer, config.parse_timeout_seconds);
+    auto parse_completed = parse_block(chain_state, hash, synchronizer, config, work_cost, budget);
+
+    // chain state only changes when a block is completely parsed
+    if (parse_completed || legacy_migrated) {
+        save_chain_state(chain_state);
+    }
+
+    auto status = parse_completed ? "parsing_completed" : get_parsing_status_name(parsing);
+    return {.status = status, .height = height, .block_hash = hash};
+}
+
+//@auth synchronizer
+[[eosio::action]]
+utxo_manage::process_block_result utxo_manage::specparse(const name& synchronizer, const uint64_t height,
+                                                         const checksum256& hash, uint64_t process_row,
+                                                         const uint64_t nonce) {
+    require_auth(synchronizer);
+
+    auto chain_state = _chain_state.get();
+    check(height > chain_state.irreversible_height && height > chain_state.migrating_height,
+          "4008:utxomng.xsat::specparse: the block is already irreversible");
+    check(!check_consensus(height, hash),
+          "4009:utxomng.xsat::specparse: the block has reached consensus, use processblock");
+
+    block_sync::passed_index_table _passed_index(BLOCK_SYNC_CONTRACT, height);
+    auto passed_index_idx = _passed_index.get_index<"byhash"_n>();
+    auto passed_index_itr = passed_index_idx.find(hash);
+    check(passed_index_itr != passed_index_idx.end(),
+          "4010:utxomng.xsat::specparse: the block has not passed verification");
+
+    pool::synchronizer_table _synchronizer(POOL_REGISTER_CONTRACT, POOL_REGISTER_CONTRACT.value);
+    _synchronizer.require_find(synchronizer.value, "4005:utxomng.xsat::specparse: only synchronizers can parse");
+
+    // fee deduction
+    resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
+    pay.send(height, hash, synchronizer, PARSE, 1);
+
+    auto config = _config.get();
+    auto current_time = current_time_point();
+    auto spec_parsing_idx = _spec_parsing.get_index<"byblockid"_n>();
+    auto spec_parsing_itr = spec_parsing_idx.find(xsat::utils::compute_block_id(height, hash));
+    if (spec_parsing_itr == spec_parsing_idx.end()) {
+        _spec_parsing.emplace(get_self(), [&](auto& row) {
+            row.id = _spec_parsing.available_primary_key();
+            row.height = height;
+            row.hash = hash;
+            row.progress = {.bucket_id = passed_index_itr->bucket_id,
+                            .parser = synchronizer,
+                            .parse_expiration_time = current_time + eosio::seconds(config.parse_timeout_seconds)};
+        });
+        spec_parsing_itr = spec_parsing_idx.find(xsat::utils::compute_block_id(height, hash));
+    }
+
+    auto parsing_progress = spec_parsing_itr->progress;
+    check(parsing_progress.num_transactions == 0
+              || parsing_progress.num_transactions != parsing_progress.parsed_transactions,
+          "4011:utxomng.xsat::specparse: the block has been parsed");
+    if (parsing_progress.num_transactions == 0) {
+        record_stage(height, hash, stage_parse_start);
+    }
+    if (parsing_progress.parse_expiration_time > current_time) {
+        check(synchronizer == parsing_progress.parser,
+              "4004:utxomng.xsat::specparse: you are not a parser of the current block");
+    } else {
+        parsing_progress.parser = synchronizer;
+        parsing_progress.parse_expiration_time = current_time + eosio::seconds(config.parse_timeout_seconds);
+    }
+
+    auto work_cost = _work_cost.get_or_default();
+    auto budget = get_work_budget(work_cost, process_row);
+    parsing_transactions(height, hash, &parsing_progress, work_cost, budget);
+
+    spec_parsing_idx.modify(spec_parsing_itr, same_payer, [&](auto& row) {
+        row.progress = parsing_progress;
+    });
+
+    auto parse_completed = parsing_progress.num_transactions > 0
+                           && parsing_progress.num_transactions == parsing_progress.parsed_transactions;
+    if (parse_completed) {
+        record_stage(height, hash, stage_parse_end);
+    }
+    auto status = parse_completed ? "parsing_completed" : get_parsing_status_name(parsing);
+    return {.status = status, .height = height, .block_hash = hash};
+}
+
+utxo_manage::work_budget utxo_manage::get_work_budget(const work_cost_row& work_cost, uint64_t process_row) {
+    // The configured budget caps the cost units requested by the caller
+    if (work_cost.budget > 0 && (process_row == 0 || process_row > work_cost.budget)) {
+        process_row = work_cost.budget;
+    }
+    if (process_row == 0)
+        process_row = -1;
+    return {.remaining = process_row};
+}
+
+utxo_manage::chain_state_row utxo_manage::get_chain_state() {
+    _stored_chain_state = _chain_state.exists() ? optional<chain_state_row>{_chain_state.get()} : nullopt;
+    auto chain_state = _stored_chain_state.value_or(chain_state_row{});
+
+    auto chain_cursor = get_chain_cursor(chain_state);
+    chain_state.num_utxos = chain_cursor.num_utxos;
+    chain_state.migrated_num_utxos = chain_cursor.migrated_num_utxos;
+    chain_state.num_validators_assigned = chain_cursor.num_validators_assigned;
+    chain_state.status = chain_cursor.status;
+    return chain_state;
+}
+
+void utxo_manage::save_chain_state(const utxo_manage::chain_state_row& chain_state) {
+    save_chain_cursor({.num_utxos = chain_state.num_utxos,
+                       .migrated_num_utxos = chain_state.migrated_num_utxos,
+                       .num_validators_assigned = chain_state.num_validators_assigned,
+                       .status = chain_state.status});
+
+    auto row = chain_state;
+    row.num_utxos = 0;
+    row.migrated_num_utxos = 0;
+    row.num_validators_assigned = 0;
+    row.status = 0;
+
+    // the rest only changes when a block moves to its next stage
+    if (!_stored_chain_state.has_value() || !is_same_chain_state(*_stored_chain_state, row)) {
+        _chain_state.set(row, get_self());
+        _stored_chain_state = row;
+    }
+}
+
+utxo_manage::chain_cursor_row utxo_manage::get_chain_cursor(const utxo_manage::chain_state_row& chain_state) {
+    if (_chain_cursor.exists()) {
+        return _chain_cursor.get();
+    }
+    // the counters stay in `chainstate` until they are first saved by this version
+    return {.num_utxos = chain_state.num_utxos,
+            .migrated_num_utxos = chain_state.migrated_num_utxos,
+            .num_validators_assigned = chain_state.num_validators_assigned,
+            .status = chain_state.status};
+}
+
+void utxo_manage::save_chain_cursor(const utxo_manage::chain_cursor_row& chain_cursor) {
+    _chain_cursor.set(chain_cursor, get_self());
+}
+
+bool utxo_manage::is_same_chain_state(const utxo_manage::chain_state_row& a, const utxo_manage::chain_state_row& b) {
+    // `parsing_progress_of` is deprecated and only ever cleared, so its size is enough
+    return a.num_utxos == b.num_utxos && a.head_height == b.head_height
+           && a.irreversible_height == b.irreversible_height && a.irreversible_hash == b.irreversible_hash
+           && a.migrating_height == b.migrating_height && a.migrating_hash == b.migrating_hash
+           && a.migrating_num_utxos == b.migrating_num_utxos && a.migrated_num_utxos == b.migrated_num_utxos
+           && a.num_provider_validators == b.num_provider_validators
+           && a.num_validators_assigned == b.num_validators_assigned && a.miner == b.miner
+           && a.synchronizer == b.synchronizer && a.parser == b.parser && a.parsed_height == b.parsed_height
+           && a.parsing_height == b.parsing_height
+           && a.parsing_progress_of.size() == b.parsing_progress_of.size() && a.status == b.status;
+}
+
+checksum256 utxo_manage::claim_parsing_block(const uint64_t height, const name& synchronizer,
+                                             const uint16_t parse_timeout_seconds) {
     // Find parsable hash
     auto current_time = current_time_point();
-    checksum256 hash;
-    for (const auto& it : chain_state.parsing_progress_of) {
-        if (it.second.parser == synchronizer || it.second.parse_expiration_time <= current_time) {
-            hash = it.first;
+    auto parsing_block_itr = _parsing_block.end();
+    for (auto itr = _parsing_block.begin(); itr != _parsing_block.end(); itr++) {
+        if (itr->progress.parser == synchronizer || itr->progress.parse_expiration_time <= current_time) {
+            parsing_block_itr = itr;
         }
     }
 
-    check(hash != ZERO_HASH, "4003:utxomng.xsat::processblock: you are not a parser of the current block");
+    check(parsing_block_itr != _parsing_block.end(),
+          "4003:utxomng.xsat::processblock: you are not a parser of the current block");
+    auto hash = parsing_block_itr->hash;
 
     // fee deduction
     resource_management::pay_action pay(RESOURCE_MANAGE_CONTRACT, {get_self(), "active"_n});
     pay.send(height, hash, synchronizer, PARSE, 1);
 
-    auto config = _config.get();
-    auto& parsing_progress = chain_state.parsing_progress_of[hash];
+    const auto& parsing_progress = parsing_block_itr->progress;
 
     // verify permissions and whether parsing times out
     if (parsing_progress.parse_expiration_time > current_time) {
@@ -346,32 +862,87 @@ utxo_manage::process_block_result utxo_manage::processblock(const name& synchron
         pool::synchronizer_table _synchronizer(POOL_REGISTER_CONTRACT, POOL_REGISTER_CONTRACT.value);
         _synchronizer.require_find(synchronizer.value, "4005:utxomng.xsat::processblock: only synchronizers can parse");
 
-        parsing_progress.parser = synchronizer;
-        parsing_progress.parse_expiration_time = current_time + eosio::seconds(config.parse_timeout_seconds);
+        // Shards of a sharded block are claimed separately, see parsing_shard
+        if (!parsing_progress.is_sharded()) {
+            _parsing_block.modify(parsing_block_itr, same_payer, [&](auto& row) {
+                row.progress.parser = synchronizer;
+                row.progress.parse_expiration_time = current_time + eosio::seconds(parse_timeout_seconds);
+            });
+        }
     }
+    return hash;
+}
 
-    // Migrate irreversible block data first and then parse the latest block
-    if (chain_state.status == waiting) {
-        if (chain_state.migrating_height > 0) {
-            chain_state.status = migrating;
+utxo_manage::parsing_progress_row utxo_manage::new_parsing_progress(const uint64_t height, const checksum256& hash,
+                                                                   const uint64_t bucket_id, const name& parser,
+                                                                   const uint16_t parse_timeout_seconds) {
+    parsing_progress_row parsing_progress = {.bucket_id = bucket_id};
+
+    // Take over the progress of a speculative parse, the verified block data is identical
+    auto spec_parsing_idx = _spec_parsing.get_index<"byblockid"_n>();
+    auto spec_parsing_itr = spec_parsing_idx.find(xsat::utils::compute_block_id(height, hash));
+    if (spec_parsing_itr != spec_parsing_idx.end()) {
+        parsing_progress = spec_parsing_itr->progress;
+        parsing_progress.bucket_id = bucket_id;
+        spec_parsing_idx.erase(spec_parsing_itr);
+    }
 
-            // issue reward
-            reward_distribution::distribute_action _distribute(REWARD_DISTRIBUTION_CONTRACT, {get_self(), "active"_n});
-            _distribute.send(chain_state.migrating_height);
-        } else {
-            chain_state.status = parsing;
-        }
+    parsing_progress.parser = parser;
+    parsing_progress.parse_expiration_time = current_time_point() + eosio::seconds(parse_timeout_seconds);
+    return parsing_progress;
+}
+
+bool utxo_manage::migrate_legacy_progress(utxo_manage::chain_state_row& chain_state) {
+    if (chain_state.parsing_progress_of.empty()) {
+        return false;
     }
 
+    // Progress saved by a previous version of the contract is moved to `parsingblks`
+    for (const auto& [parsing_hash, parsing_progress] : chain_state.parsing_progress_of) {
+        save_parsing_block(chain_state.parsing_height, parsing_hash, parsing_progress);
+    }
+    chain_state.parsing_progress_of.clear();
+    return true;
+}
+
+void utxo_manage::start_migration(utxo_manage::chain_state_row& chain_state) {
+    chain_state.status = migrating;
+
+    // issue reward
+    reward_distribution::distribute_action _distribute(REWARD_DISTRIBUTION_CONTRACT, {get_self(), "active"_n});
+    _distribute.send(chain_state.migrating_height);
+}
+
+void utxo_manage::save_parsing_block(const uint64_t height, const checksum256& hash,
+                                     const parsing_progress_row& progress) {
+    auto parsing_block_itr = _parsing_block.find(progress.bucket_id);
+    if (parsing_block_itr == _parsing_block.end()) {
+        _parsing_block.emplace(get_self(), [&](auto& row) {
+            row.height = height;
+            row.hash = hash;
+            row.progress = progress;
+        });
+    } else {
+        _parsing_block.modify(parsing_block_itr, same_payer, [&](auto& row) {
+            row.progress = progress;
+        });
+    }
+}
+
+void utxo_manage::process_irreversible_block(utxo_manage::chain_state_row& chain_state,
+                                             const utxo_manage::config_row& config, const work_cost_row& work_cost,
+                                             work_budget& budget) {
     if (chain_state.status == migrating) {
-        migrate(chain_state, process_row);
+        migrate(chain_state, work_cost, budget);
 
         // next action
         if (chain_state.migrating_num_utxos == chain_state.migrated_num_utxos) {
             chain_state.status = deleting_data;
+            record_stage(chain_state.migrating_height, chain_state.migrating_hash, stage_migration_done,
+                         chain_state.migrated_num_utxos);
         }
     } else if (chain_state.status == deleting_data) {
-        delete_data(chain_state, config.retained_spent_utxo_blocks, config.num_retain_data_blocks, process_row);
+        delete_data(chain_state, config.retained_spent_utxo_blocks, config.num_retain_data_blocks, work_cost, budget);
     } else if (chain_state.status == distributing_rewards) {
         auto from_index = chain_state.num_validators_assigned;
         auto to_index = from_index + config.num_validators_per_distribution;
@@ -395,6 +966,7 @@ utxo_manage::process_block_result utxo_manage::processblock(const name& synchron
         }
 
         if (chain_state.num_provider_validators == chain_state.num_validators_assigned) {
+            record_stage(chain_state.migrating_height, chain_state.migrating_hash, stage_irreversible);
             chain_state.irreversible_height = chain_state.migrating_height;
             chain_state.irreversible_hash = chain_state.migrating_hash;
             chain_state.migrating_height = 0;
@@ -407,48 +979,79 @@ utxo_manage::process_block_result utxo_manage::processblock(const name& synchron
             chain_state.miner = {};
             chain_state.parser = {};
             chain_state.status = parsing;
-        }
-    } else if (chain_state.status == parsing) {
-        parsing_transactions(height, hash, &parsing_progress, process_row);
-
-        if (parsing_progress.num_transactions == parsing_progress.parsed_transactions) {
-            auto consensus_block_itr = _consensus_block.require_find(parsing_progress.bucket_id);
-            _consensus_block.modify(consensus_block_itr, same_payer, [&](auto& row) {
-                row.parse = true;
-                row.parser = synchronizer;
-                row.num_utxos = parsing_progress.num_utxos;
-            });
 
-            chain_state.parsing_progress_of.erase(hash);
+            // The pipelined parse may have finished first, the next irreversible block is then migrated on its own
+            if (_parsing_block.begin() == _parsing_block.end()) {
+                chain_state.status = waiting;
+            }
+            find_set_next_irreversible_block(chain_state);
         }
+    }
+}
 
-        // If all are parsed, set the next parsed block
-        if (chain_state.parsing_progress_of.empty()) {
-            chain_state.status = waiting;
-            chain_state.parsed_height = height;
-            chain_state.parsing_height = 0;
+bool utxo_manage::parse_block(utxo_manage::chain_state_row& chain_state, const checksum256& hash,
+                              const name& synchronizer, const utxo_manage::config_row& config,
+                              const work_cost_row& work_cost, work_budget& budget) {
+    auto height = chain_state.parsing_height;
+    auto parsing_block_idx = _parsing_block.get_index<"byhash"_n>();
+    auto parsing_block_itr = parsing_block_idx.require_find(hash);
+    auto parsing_progress = parsing_block_itr->progress;
+    if (parsing_progress.num_transactions == 0) {
+        record_stage(height, hash, stage_parse_start);
+    }
 
-            // Set the latest parsable block height
-            find_set_next_parsable_block(chain_state, config.parse_timeout_seconds);
+    // Split large blocks before the first transaction is parsed, the split itself may take several calls
+    auto num_txs_per_shard = config.get_num_txs_per_shard();
+    auto splitting = num_txs_per_shard > 0 && parsing_progress.num_transactions == 0
+                     && split_parse_shards(&parsing_progress, num_txs_per_shard, work_cost, budget);
 
-            // Set the block height of the latest migration
-            find_set_next_irreversible_block(chain_state);
-        }
+    if (splitting) {
+        // shards can only be parsed once all of their start positions are recorded
+    } else if (parsing_progress.is_sharded()) {
+        parsing_shard(height, hash, synchronizer, &parsing_progress, config.parse_timeout_seconds, work_cost, budget);
+    } else {
+        parsing_transactions(height, hash, &parsing_progress, work_cost, budget);
     }
 
-    // save state
-    _chain_state.set(chain_state, get_self());
+    auto parse_completed = parsing_progress.num_transactions > 0
+                           && parsing_progress.num_transactions == parsing_progress.parsed_transactions;
+    if (parse_completed) {
+        auto consensus_block_itr = _consensus_block.require_find(parsing_progress.bucket_id);
+        _consensus_block.modify(consensus_block_itr, same_payer, [&](auto& row) {
+            row.parse = true;
+            row.parser = synchronizer;
+            row.num_utxos = parsing_progress.num_utxos;
+        });
 
-    auto status = get_parsing_status_name(chain_state.status);
-    if (parsing_progress.num_transactions > 0
-        && parsing_progress.num_transactions == parsing_progress.parsed_transactions) {
-        status = "parsing_completed";
+        parsing_block_idx.erase(parsing_block_itr);
+        record_stage(height, hash, stage_parse_end);
+    } else {
+        parsing_block_idx.modify(parsing_block_itr, same_payer, [&](auto& row) {
+            row.progress = parsing_progress;
+        });
     }
-    return {.status = status, .height = height, .block_hash = hash};
+
+    // If all are parsed, set the next parsed block
+    if (_parsing_block.begin() == _parsing_block.end()) {
+        // A pipelined migration keeps its own status until it is finished
+        if (!is_migration_phase(chain_state.status)) {
+            chain_state.status = waiting;
+        }
+        chain_state.parsed_height = height;
+        chain_state.parsing_height = 0;
+
+        // Set the latest parsable block height
+        find_set_next_parsable_block(chain_state, config.parse_timeout_seconds);
+
+        // Set the block height of the latest migration
+        find_set_next_irreversible_block(chain_state);
+    }
+    return parse_completed;
 }
 
 void utxo_manage::parsing_transactions(const uint64_t height, const checksum256& hash,
-                                       parsing_progress_row* parsing_progress, uint64_t process_row) {
+                                       parsing_progress_row* parsing_progress, const work_cost_row& work_cost,
+                                       work_budget& budget) {
     auto block_data = block_sync::read_bucket(BLOCK_SYNC_CONTRACT, parsing_progress->bucket_id, BLOCK_CHUNK,
                                               BLOCK_HEADER_SIZE + parsing_progress->parsed_position,
                                               std::numeric_limits<uint64_t>::max());
@@ -459,20 +1062,19 @@ void utxo_manage::parsing_transactions(const uint64_t height, const checksum256&
         parsing_progress->num_transactions = bitcoin::varint::decode(block_stream);
     }
 
-    if (process_row == 0)
-        process_row = -1;
-
     uint64_t parsed_position = 0;
     std::vector<uint8_t> script_data = {};
     auto pending_transactions = parsing_progress->num_transactions - parsing_progress->parsed_transactions;
-    while (pending_transactions-- && process_row) {
+    while (pending_transactions-- && budget.available()) {
         bitcoin::core::transaction transaction(&block_data);
+        auto tx_position = block_stream.tellp();
         block_stream >> transaction;
         auto txid = bitcoin::be_checksum256_from_uint(transaction.merkle_hash());
+        budget.charge((block_stream.tellp() - tx_position) * work_cost.deserialize_kbytes / 1024);
 
         // save vin
-        for (; parsing_progress->parsed_vin < transaction.inputs.size() && process_row;
-             parsing_progress->parsed_vin++, process_row--) {
+        for (; parsing_progress->parsed_vin < transaction.inputs.size() && budget.available();
+             parsing_progress->parsed_vin++, budget.consume(work_cost.pending_emplace)) {
             auto vin = transaction.inputs[parsing_progress->parsed_vin];
             if (transaction.is_coinbase())
                 continue;
@@ -483,8 +1085,8 @@ void utxo_manage::parsing_transactions(const uint64_t height, const checksum256&
         }
 
         // save vout
-        for (; parsing_progress->parsed_vout < transaction.outputs.size() && process_row;
-             parsing_progress->parsed_vout++, process_row--) {
+        for (; parsing_progress->parsed_vout < transaction.outputs.size() && budget.available();
+             parsing_progress->parsed_vout++, budget.consume(work_cost.pending_emplace)) {
             auto vout = transaction.outputs[parsing_progress->parsed_vout];
 
             if (xsat::utils::is_unspendable_legacy(vout.script.data))
@@ -506,62 +1108,208 @@ void utxo_manage::parsing_transactions(const uint64_t height, const checksum256&
     parsing_progress->parsed_position += parsed_position;
 }
 
-void utxo_manage::migrate(utxo_manage::chain_state_row& chain_state, uint64_t process_row) {
-    if (process_row == 0)
-        process_row = -1;
+bool utxo_manage::split_parse_shards(parsing_progress_row* parsing_progress, const uint32_t num_txs_per_shard,
+                                     const work_cost_row& work_cost, work_budget& budget) {
+    parse_split_table _parse_split(get_self(), parsing_progress->bucket_id);
+    auto parse_split = _parse_split.get_or_default();
+    if (!_parse_split.exists()) {
+        // Only the transaction count is read to decide whether the block is sharded
+        auto count_data = block_sync::read_bucket(BLOCK_SYNC_CONTRACT, parsing_progress->bucket_id, BLOCK_CHUNK,
+                                                  BLOCK_HEADER_SIZE, BLOCK_HEADER_SIZE + MAX_VARINT_SIZE);
+        eosio::datastream<const char*> count_stream(count_data.data(), count_data.size());
+        auto num_transactions = bitcoin::varint::decode(count_stream);
+        if (num_transactions <= num_txs_per_shard) {
+            return false;
+        }
+        parse_split = {.num_transactions = num_transactions,
+                       .num_txs_per_shard = num_txs_per_shard,
+                       .split_transactions = 0,
+                       .split_position = count_stream.tellp()};
+    }
+
+    // Record the start position of each shard as the split cursor passes it, the last shard is not deserialized
+    auto block_data = block_sync::read_bucket(BLOCK_SYNC_CONTRACT, parsing_progress->bucket_id, BLOCK_CHUNK,
+                                              BLOCK_HEADER_SIZE + parse_split.split_position,
+                                              std::numeric_limits<uint64_t>::max());
+    eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
+    parse_shard_table _parse_shard(get_self(), parsing_progress->bucket_id);
+    auto shard_size = parse_split.num_txs_per_shard;
+    auto last_shard_start = (parse_split.num_transactions - 1) / shard_size * shard_size;
+    auto split_completed = false;
+    while (!split_completed && budget.available()) {
+        if (parse_split.split_transactions % shard_size == 0) {
+            auto start_transaction = parse_split.split_transactions;
+            _parse_shard.emplace(get_self(), [&](auto& row) {
+                row.id = start_transaction / shard_size;
+                row.start_transaction = start_transaction;
+                row.progress = {.bucket_id = parsing_progress->bucket_id,
+                                .num_transactions = std::min<uint64_t>(shard_size, parse_split.num_transactions - start_transaction),
+                                .parsed_position = parse_split.split_position};
+            });
+            budget.consume(work_cost.pending_emplace);
+            if (start_transaction == last_shard_start) {
+                split_completed = true;
+                break;
+            }
+        }
+
+        auto tx_position = block_stream.tellp();
+        bitcoin::core::transaction transaction(&block_data);
+        block_stream >> transaction;
+        auto tx_size = block_stream.tellp() - tx_position;
+        parse_split.split_transactions++;
+        parse_split.split_position += tx_size;
+        budget.consume(std::max<uint64_t>(tx_size * work_cost.deserialize_kbytes / 1024, 1));
+    }
+
+    if (!split_completed) {
+        _parse_split.set(parse_split, get_self());
+        return true;
+    }
+    _parse_split.remove();
+
+    // An empty parser marks the block as sharded, the block progress only accumulates the shard progress
+    parsing_progress->num_transactions = parse_split.num_transactions;
+    parsing_progress->parsed_position = parse_split.split_position;
+    parsing_progress->parser = {};
+    parsing_progress->parse_expiration_time = {};
+    return false;
+}
+
+void utxo_manage::parsing_shard(const uint64_t height, const checksum256& hash, const name& synchronizer,
+                                parsing_progress_row* parsing_progress, const uint16_t parse_timeout_seconds,
+                                const work_cost_row& work_cost, work_budget& budget) {
+    parse_shard_table _parse_shard(get_self(), parsing_progress->bucket_id);
+
+    // Continue the shard held by the synchronizer, otherwise claim the first unclaimed or expired one
+    auto current_time = current_time_point();
+    auto shard_itr = _parse_shard.end();
+    for (auto itr = _parse_shard.begin(); itr != _parse_shard.end(); itr++) {
+        if (itr->progress.parser == synchronizer) {
+            shard_itr = itr;
+            break;
+        }
+        if (shard_itr == _parse_shard.end() && itr->progress.parse_expiration_time <= current_time) {
+            shard_itr = itr;
+        }
+    }
+    check(shard_itr != _parse_shard.end(),
+          "4007:utxomng.xsat::processblock: all shards of the current block are being parsed");
+
+    auto progress = shard_itr->progress;
+    if (progress.parser != synchronizer) {
+        progress.parser = synchronizer;
+        progress.parse_expiration_time = current_time + eosio::seconds(parse_timeout_seconds);
+    }
+
+    parsing_transactions(height, hash, &progress, work_cost, budget);
+
+    parsing_progress->parsed_transactions += progress.parsed_transactions - shard_itr->progress.parsed_transactions;
+    parsing_progress->num_utxos += progress.num_utxos - shard_itr->progress.num_utxos;
+    if (progress.parsed_transactions == progress.num_transactions) {
+        _parse_shard.erase(shard_itr);
+    } else {
+        _parse_shard.modify(shard_itr, same_payer, [&](auto& row) {
+            row.progress = progress;
+        });
+    }
+}
 
+void utxo_manage::migrate(utxo_manage::chain_state_row& chain_state, const work_cost_row& work_cost,
+                          work_budget& budget) {
     auto block_id = xsat::utils::compute_block_id(chain_state.migrating_height, chain_state.migrating_hash);
     auto pending_utxo_idx = _pending_utxo.get_index<"byblockid"_n>();
     auto start_itr = pending_utxo_idx.lower_bound(block_id);
     auto end_itr = pending_utxo_idx.upper_bound(block_id);
 
+    auto utxo_set_hash = get_utxo_set_hash();
     auto utxo_idx = _utxo.get_index<"byutxoid"_n>();
-    while (start_itr != end_itr && process_row--) {
+    while (start_itr != end_itr && budget.available()) {
+        uint64_t cost = work_cost.pending_erase;
         if (start_itr->type == "vin"_n) {
-            auto prev_utxo = remove_utxo(utxo_idx, start_itr->txid, start_itr->index);
+            auto prev_utxo
+                = remove_utxo(utxo_idx, start_itr->txid, start_itr->index, utxo_set_hash, work_cost, budget);
+            cost += work_cost.remove_utxo;
             if (prev_utxo.has_value()) {
                 chain_state.num_utxos -= 1;
+            } else {
+                // A block parsed in shards can spend an output of the same block before that output is migrated
+                prev_utxo = remove_pending_vout(*start_itr);
+                if (prev_utxo.has_value()) {
+                    chain_state.migrated_num_utxos++;
+                    cost += work_cost.pending_erase;
+                } else {
+                    // log
+                    utxo_manage::lostutxolog_action _lostutxolog(get_self(), {get_self(), "active"_n});
+                    _lostutxolog.send(start_itr->txid, start_itr->index);
+                }
+            }
 
+            if (prev_utxo.has_value()) {
                 // migrate to utxo  table
                 save_spent_utxo(start_itr->height, *prev_utxo);
+                cost += work_cost.save_spent_utxo;
             }
         } else {
-            save_utxo(start_itr->txid, start_itr->index, start_itr->scriptpubkey, start_itr->value);
+            save_utxo(start_itr->txid, start_itr->index, start_itr->scriptpubkey, start_itr->value, utxo_set_hash);
             chain_state.num_utxos += 1;
+            cost += work_cost.save_utxo;
         }
 
         // erase pending utxo
         start_itr = pending_utxo_idx.erase(start_itr);
+        budget.consume(cost);
 
         chain_state.migrated_num_utxos++;
     }
+    save_utxo_set_hash(utxo_set_hash);
 }
 
 void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const uint16_t retained_spent_utxo_blocks,
-                              const uint16_t num_retain_data_blocks, uint64_t process_row) {
+                              const uint16_t num_retain_data_blocks, const work_cost_row& work_cost,
+                              work_budget& budget) {
     // Batch delete forked pendingutxos
     auto pending_utxo_idx = _pending_utxo.get_index<"byheight"_n>();
     auto pending_utxo_itr = pending_utxo_idx.lower_bound(chain_state.migrating_height);
     auto pending_utxo_end = pending_utxo_idx.upper_bound(chain_state.migrating_height);
     if (pending_utxo_itr != pending_utxo_end) {
-        while (pending_utxo_itr != pending_utxo_end && process_row--) {
+        while (pending_utxo_itr != pending_utxo_end && budget.available()) {
             pending_utxo_itr = pending_utxo_idx.erase(pending_utxo_itr);
+            budget.consume(work_cost.pending_erase);
         }
         return;
     }
 
-    // Delete spentutxos in batches
+    // Delete speculative parsing progress of forked blocks
+    auto spec_parsing_idx = _spec_parsing.get_index<"byheight"_n>();
+    auto spec_parsing_itr = spec_parsing_idx.lower_bound(chain_state.migrating_height);
+    auto spec_parsing_end = spec_parsing_idx.upper_bound(chain_state.migrating_height);
+    if (spec_parsing_itr != spec_parsing_end) {
+        while (spec_parsing_itr != spec_parsing_end && budget.available()) {
+            spec_parsing_itr = spec_parsing_idx.erase(spec_parsing_itr);
+            budget.consume(work_cost.pending_erase);
+        }
+        return;
+    }
+
+    // Delete legacy spentutxos in batches
     auto del_history_height = chain_state.migrating_height - retained_spent_utxo_blocks;
     auto spent_utxo_idx = _spent_utxo.get_index<"byheight"_n>();
     auto spent_utxo_itr = spent_utxo_idx.lower_bound(del_history_height);
     auto spent_utxo_end = spent_utxo_idx.upper_bound(del_history_height);
     if (spent_utxo_itr != spent_utxo_end) {
-        while (spent_utxo_itr != spent_utxo_end && process_row--) {
+        while (spent_utxo_itr != spent_utxo_end && budget.available()) {
             spent_utxo_itr = spent_utxo_idx.erase(spent_utxo_itr);
+            budget.consume(work_cost.pending_erase);
         }
         return;
     }
 
+    // Reclaim expired spent log scopes
+    if (!prune_spent_log(del_history_height, work_cost.pending_erase, budget)) {
+        return;
+    }
+
     block_sync::delchunks_action _delchunks(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n});
 
     // erase endorsement
@@ -576,6 +1324,13 @@ void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const u
         _block_extra.erase(block_extra_itr);
     }
 
+    // erase old block timelines, including those of blocks that never reached consensus
+    auto block_timeline_idx = _block_timeline.get_index<"byheight"_n>();
+    auto block_timeline_itr = block_timeline_idx.begin();
+    while (block_timeline_itr != block_timeline_idx.end() && block_timeline_itr->height <= del_height) {
+        block_timeline_itr = block_timeline_idx.erase(block_timeline_itr);
+    }
+
     // erase consensus block
     consensus_block_row consensus_block;
     auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
@@ -593,28 +1348,260 @@ void utxo_manage::delete_data(utxo_manage::chain_state_row& chain_state, const u
     }
 
     // save irreversible block
-    _block.emplace(get_self(), [&](auto& row) {
-        row.height = consensus_block.height;
-        row.hash = consensus_block.hash;
-        row.cumulative_work = consensus_block.cumulative_work;
-        row.version = consensus_block.version;
-        row.previous_block_hash = consensus_block.previous_block_hash;
-        row.merkle = consensus_block.merkle;
-        row.timestamp = consensus_block.timestamp;
-        row.bits = consensus_block.bits;
-        row.nonce = consensus_block.nonce;
-    });
+    archive_block_header(consensus_block);
+
+    // the commitment is only published once every existing utxo has been folded into it
+    auto utxo_set = _utxo_set.get_or_default();
+    if (_backfill.get_or_default().completed) {
+        utxo_set.commitment = get_utxo_set_hash().finalize();
+        _utxo_set.set(utxo_set, get_self());
+    }
 
     // save block extra
     _block_extra.emplace(get_self(), [&](auto& row) {
         row.height = chain_state.migrating_height;
         row.bucket_id = consensus_block.bucket_id;
+        row.utxo_commitment = utxo_set.commitment;
+        row.num_utxos = chain_state.num_utxos;
     });
 
     // next action
     chain_state.status = distributing_rewards;
 }
 
+void utxo_manage::archive_block_header(const utxo_manage::consensus_block_row& block) {
+    std::vector<uint8_t> record(HEADER_RECORD_SIZE);
+    eosio::datastream<char*> ds((char*)record.data(), record.size());
+    ds << block.hash << block.cumulative_work << block.version << block.merkle << block.timestamp << block.bits
+       << block.nonce;
+
+    auto header_chunk_itr = _header_chunk.find(block.height / HEADERS_PER_CHUNK);
+    if (header_chunk_itr == _header_chunk.end()) {
+        _header_chunk.emplace(get_self(), [&](auto& row) {
+            row.id = block.height / HEADERS_PER_CHUNK;
+            row.start_height = block.height;
+            row.headers = record;
+        });
+    } else {
+        auto next_height = header_chunk_itr->start_height + header_chunk_itr->headers.size() / HEADER_RECORD_SIZE;
+        check(next_height == block.height,
+              "4012:utxomng.xsat::processblock: block headers must be archived consecutively");
+        _header_chunk.modify(header_chunk_itr, same_payer, [&](auto& row) {
+            row.headers.insert(row.headers.end(), record.begin(), record.end());
+        });
+    }
+}
+
+void utxo_manage::prune_forks(const utxo_manage::chain_state_row& chain_state, const work_cost_row& work_cost,
+                              work_budget& budget) {
+    if (!budget.available())
+        return;
+
+    // Heights up to the migrating block are decided, forks above it are pruned once their ancestor is pruned
+    auto decided_height = chain_state.migrating_height > 0 ? chain_state.migrating_height : chain_state.irreversible_height;
+    auto fork_prune = _fork_prune.get_or_default();
+    auto pruned_height = std::max(fork_prune.pruned_height, chain_state.irreversible_height);
+    auto height = pruned_height + 1;
+
+    auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
+    for (; height <= chain_state.head_height && budget.available(); height++) {
+        auto consensus_block_itr = consensus_block_idx.lower_bound(height);
+        auto consensus_block_end = consensus_block_idx.upper_bound(height);
+        while (consensus_block_itr != consensus_block_end && budget.available()) {
+            // Blocks being parsed are left to `delete_data`
+            if (!is_losing_fork(chain_state, *consensus_block_itr)
+                || _parsing_block.find(consensus_block_itr->bucket_id) != _parsing_block.end()) {
+                consensus_block_itr++;
+            } else if (prune_fork_block(*consensus_block_itr, work_cost.pending_erase, budget)) {
+                consensus_block_itr = consensus_block_idx.erase(consensus_block_itr);
+            }
+        }
+
+        if (consensus_block_itr == consensus_block_end && height <= decided_height && pruned_height == height - 1) {
+            pruned_height = height;
+        }
+    }
+
+    if (pruned_height != fork_prune.pruned_height) {
+        fork_prune.pruned_height = pruned_height;
+        _fork_prune.set(fork_prune, get_self());
+    }
+}
+
+bool utxo_manage::is_losing_fork(const utxo_manage::chain_state_row& chain_state,
+                                 const utxo_manage::consensus_block_row& block) {
+    if (block.height == chain_state.migrating_height) {
+        return block.hash != chain_state.migrating_hash;
+    }
+
+    // A block whose parent has been pruned is on a losing fork
+    auto parent_height = block.height - 1;
+    if (parent_height == chain_state.migrating_height) {
+        return block.previous_block_hash != chain_state.migrating_hash;
+    }
+    if (parent_height == chain_state.irreversible_height) {
+        return block.previous_block_hash != chain_state.irreversible_hash;
+    }
+    auto block_id_idx = _consensus_block.get_index<"byblockid"_n>();
+    return block_id_idx.find(xsat::utils::compute_block_id(parent_height, block.previous_block_hash))
+           == block_id_idx.end();
+}
+
+bool utxo_manage::prune_fork_block(const utxo_manage::consensus_block_row& block, const uint32_t erase_cost,
+                                   work_budget& budget) {
+    // Pending utxos parsed for the block
+    auto block_id = xsat::utils::compute_block_id(block.height, block.hash);
+    auto pending_utxo_idx = _pending_utxo.get_index<"byblockid"_n>();
+    auto pending_utxo_itr = pending_utxo_idx.lower_bound(block_id);
+    auto pending_utxo_end = pending_utxo_idx.upper_bound(block_id);
+    while (pending_utxo_itr != pending_utxo_end && budget.available()) {
+        pending_utxo_itr = pending_utxo_idx.erase(pending_utxo_itr);
+        budget.consume(erase_cost);
+    }
+    if (pending_utxo_itr != pending_utxo_end) {
+        return false;
+    }
+
+    auto spec_parsing_idx = _spec_parsing.get_index<"byblockid"_n>();
+    auto spec_parsing_itr = spec_parsing_idx.find(block_id);
+    if (spec_parsing_itr != spec_parsing_idx.end()) {
+        spec_parsing_idx.erase(spec_parsing_itr);
+    }
+
+    auto block_timeline_idx = _block_timeline.get_index<"byblockid"_n>();
+    auto block_timeline_itr = block_timeline_idx.find(block_id);
+    if (block_timeline_itr != block_timeline_idx.end()) {
+        block_timeline_idx.erase(block_timeline_itr);
+    }
+
+    parse_shard_table _parse_shard(get_self(), block.bucket_id);
+    auto parse_shard_itr = _parse_shard.begin();
+    while (parse_shard_itr != _parse_shard.end()) {
+        parse_shard_itr = _parse_shard.erase(parse_shard_itr);
+    }
+    parse_split_table _parse_split(get_self(), block.bucket_id);
+    _parse_split.remove();
+
+    // erase block chunks
+    block_sync::delchunks_action _delchunks(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n});
+    _delchunks.send(block.bucket_id);
+
+    // erase endorsements
+    block_endorse::erasefork_action _erasefork(BLOCK_ENDORSE_CONTRACT, {get_self(), "active"_n});
+    _erasefork.send(block.height, block.hash);
+
+    budget.consume(erase_cost);
+    return true;
+}
+
+void utxo_manage::collect_garbage(const utxo_manage::chain_state_row& chain_state,
+                                  const utxo_manage::config_row& config, const work_cost_row& work_cost,
+                                  work_budget& call_budget) {
+    if (!call_budget.available() || !_gc_config.exists())
+        return;
+
+    // cleanup has its own cap, so an unbounded call does not run it unbounded
+    auto gc_config = _gc_config.get();
+    auto gc_rows = std::min(call_budget.remaining, gc_config.max_rows);
+    work_budget budget = {.remaining = gc_rows};
+    auto gc_state = _gc_state.get_or_default();
+    auto erase_cost = std::max<uint64_t>(work_cost.pending_erase, 1);
+    uint16_t num_actions = 0;
+    auto get_retained_height = [&](const uint64_t retained_blocks) {
+        return chain_state.irreversible_height > retained_blocks ? chain_state.irreversible_height - retained_blocks
+                                                                 : 0;
+    };
+
+    // spent utxos and spent logs
+    auto spent_utxo_target = get_retained_height(config.retained_spent_utxo_blocks);
+    if (gc_state.spent_utxo_height < spent_utxo_target) {
+        auto spent_utxo_idx = _spent_utxo.get_index<"byheight"_n>();
+        auto spent_utxo_itr = spent_utxo_idx.begin();
+        auto spent_utxo_end = spent_utxo_idx.upper_bound(spent_utxo_target);
+        while (spent_utxo_itr != spent_utxo_end && budget.available()) {
+            spent_utxo_itr = spent_utxo_idx.erase(spent_utxo_itr);
+            budget.consume(erase_cost);
+        }
+        if (spent_utxo_itr == spent_utxo_end && prune_spent_log(spent_utxo_target, erase_cost, budget)) {
+            gc_state.spent_utxo_height = spent_utxo_target;
+        }
+    }
+
+    // block data
+    block_sync::delchunks_action _delchunks(BLOCK_SYNC_CONTRACT, {get_self(), "active"_n});
+    auto block_data_target = get_retained_height(config.num_retain_data_blocks);
+    auto block_extra_itr = _block_extra.begin();
+    while (block_extra_itr != _block_extra.end() && block_extra_itr->height <= block_data_target
+           && budget.available() && num_actions < gc_config.max_actions) {
+        _delchunks.send(block_extra_itr->bucket_id);
+        block_extra_itr = _block_extra.erase(block_extra_itr);
+        budget.consume(erase_cost);
+        num_actions++;
+    }
+    if (block_extra_itr == _block_extra.end() || block_extra_itr->height > block_data_target) {
+        gc_state.block_data_height = block_data_target;
+    } else {
+        gc_state.block_data_height = block_extra_itr->height - 1;
+    }
+
+    gasfund::fees_stat_table _fees_stat(GAS_FUND_CONTRACT, GAS_FUND_CONTRACT.value);
+    auto fees_stat = _fees_stat.get_or_default();
+
+    // rwddist reward logs, which can only be deleted after gasfund has settled the fees
+    uint64_t reward_log_target = 0;
+    if (gc_config.retained_reward_log_blocks > 0) {
+        reward_log_target
+            = std::min(get_retained_height(gc_config.retained_reward_log_blocks), fees_stat.last_height);
+        if (gc_state.reward_log_height < START_HEIGHT) {
+            gc_state.reward_log_height = START_HEIGHT;
+        }
+        if (gc_state.reward_log_height < reward_log_target && budget.available()
+            && num_actions < gc_config.max_actions) {
+            auto num_heights = std::min(reward_log_target - gc_state.reward_log_height, MAX_GC_HEIGHTS_PER_ACTION);
+            num_heights = std::max<uint64_t>(std::min(num_heights, budget.remaining / (2 * erase_cost)), 1);
+            reward_distribution::delrewardlog_action _delrewardlog(REWARD_DISTRIBUTION_CONTRACT,
+                                                                   {get_self(), "active"_n});
+            _delrewardlog.send(gc_state.reward_log_height + 1, gc_state.reward_log_height + num_heights);
+            gc_state.reward_log_height += num_heights;
+            budget.consume(2 * erase_cost * num_heights);
+            num_actions++;
+        }
+    }
+
+    // gasfund distributions, which can only be deleted before the last evm distribution
+    uint64_t distribution_target = 0;
+    if (gc_config.retained_distribution_blocks > 0) {
+        distribution_target = get_retained_height(gc_config.retained_distribution_blocks);
+        if (distribution_target >= fees_stat.last_evm_height) {
+            distribution_target = fees_stat.last_evm_height > 0 ? fees_stat.last_evm_height - 1 : 0;
+        }
+        gasfund::distribute_table _distribute(GAS_FUND_CONTRACT, GAS_FUND_CONTRACT.value);
+        auto distribute_itr = _distribute.lower_bound(gc_state.distribution_height + 1);
+        gasfund::deldistribut_action _deldistribut(GAS_FUND_CONTRACT, {get_self(), "active"_n});
+        while (distribute_itr != _distribute.end() && distribute_itr->start_height <= distribution_target
+               && budget.available() && num_actions < gc_config.max_actions) {
+            _deldistribut.send(distribute_itr->start_height);
+            gc_state.distribution_height = distribute_itr->start_height;
+            budget.consume(erase_cost);
+            num_actions++;
+            distribute_itr++;
+        }
+        if (distribute_itr == _distribute.end() || distribute_itr->start_height > distribution_target) {
+            gc_state.distribution_height = std::max(gc_state.distribution_height, distribution_target);
+        }
+    }
+
+    gc_state.backlog = (spent_utxo_target - std::min(spent_utxo_target, gc_state.spent_utxo_height))
+                       + (block_data_target - std::min(block_data_target, gc_state.block_data_height))
+                       + (reward_log_target - std::min(reward_log_target, gc_state.reward_log_height))
+                       + (distribution_target - std::min(distribution_target, gc_state.distribution_height));
+    _gc_state.set(gc_state, get_self());
+
+    if (budget.remaining < gc_rows) {
+        call_budget.consume(gc_rows - budget.remaining);
+    }
+}
+
 void utxo_manage::find_set_next_parsable_block(utxo_manage::chain_state_row& chain_state,
                                                const uint16_t parse_timeout_seconds) {
     if (chain_state.parsing_height != 0)
@@ -633,18 +1620,19 @@ void utxo_manage::find_set_next_parsable_block(utxo_manage::chain_state_row& cha
         } else if (chain_state.parsing_height != consensus_block_itr->height) {
             break;
         }
-        chain_state.parsing_progress_of[consensus_block_itr->hash]
-            = {.bucket_id = consensus_block_itr->bucket_id,
-               .parser = consensus_block_itr->synchronizer,
-               .parse_expiration_time = current_time_point() + eosio::seconds(parse_timeout_seconds)};
+        save_parsing_block(consensus_block_itr->height, consensus_block_itr->hash,
+                           new_parsing_progress(consensus_block_itr->height, consensus_block_itr->hash,
+                                                consensus_block_itr->bucket_id, consensus_block_itr->synchronizer,
+                                                parse_timeout_seconds));
         consensus_block_itr++;
     }
 }
 
 void utxo_manage::find_set_next_irreversible_block(utxo_manage::chain_state_row& chain_state) {
-    // Verify whether the next irreversible block needs to be migrated
-    if (chain_state.migrating_height != 0
-        || chain_state.parsing_height <= chain_state.irreversible_height + IRREVERSIBLE_BLOCKS) {
+    // The next irreversible block and its confirmations must have been parsed, every block up to the head block is
+    // parsed when nothing is being parsed
+    auto unparsed_height = chain_state.parsing_height > 0 ? chain_state.parsing_height : chain_state.head_height + 1;
+    if (chain_state.migrating_height != 0 || unparsed_height <= chain_state.irreversible_height + IRREVERSIBLE_BLOCKS) {
         return;
     }
 
@@ -674,13 +1662,13 @@ void utxo_manage::find_set_next_irreversible_block(utxo_manage::chain_state_row&
         auto endorsement_idx_xsat = endorsement_xsat.get_index<"byhash"_n>();
         auto itr_xsat = endorsement_idx_xsat.find(chain_state.migrating_hash);
         if (itr_xsat != endorsement_idx_xsat.end()) {
-            chain_state.num_provider_validators = std::max(endorsement_itr->provider_validators.size(), 
-                                                         itr_xsat->provider_validators.size());
+            chain_state.num_provider_validators = std::max(endorsement_itr->num_providers(), 
+                                                         itr_xsat->num_providers());
         } else {
-            chain_state.num_provider_validators = endorsement_itr->provider_validators.size();
+            chain_state.num_provider_validators = endorsement_itr->num_providers();
         }
     } else {
-        chain_state.num_provider_validators = endorsement_itr->provider_validators.size();
+        chain_state.num_provider_validators = endorsement_itr->num_providers();
     }
 
 
@@ -731,20 +1719,39 @@ utxo_manage::consensus_block_row utxo_manage::find_next_irreversible_block(const
 }
 
 void utxo_manage::save_spent_utxo(const uint64_t height, const utxo_manage::utxo_row& utxo) {
-    auto id = _spent_utxo.available_primary_key();
-    if (id == 0) {
-        id = 1;
-    }
-    _spent_utxo.emplace(get_self(), [&](auto& row) {
-        row.id = id;
-        row.height = height;
+    spent_log_table _spent_log(get_self(), height);
+    _spent_log.emplace(get_self(), [&](auto& row) {
+        row.id = _spent_log.available_primary_key();
         row.txid = utxo.txid;
         row.index = utxo.index;
-        row.scriptpubkey = utxo.scriptpubkey;
+        row.script = xsat::utils::compress_script(utxo.scriptpubkey);
         row.value = utxo.value;
     });
 }
 
+bool utxo_manage::prune_spent_log(const uint64_t height, const uint32_t erase_cost, work_budget& budget) {
+    // The log did not exist before this height, so there is nothing older to reclaim
+    auto spent_state = _spent_state.get_or_default();
+    if (!_spent_state.exists()) {
+        spent_state.pruned_height = height - 1;
+    }
+
+    while (spent_state.pruned_height < height) {
+        spent_log_table _spent_log(get_self(), spent_state.pruned_height + 1);
+        auto spent_log_itr = _spent_log.begin();
+        while (spent_log_itr != _spent_log.end() && budget.available()) {
+            spent_log_itr = _spent_log.erase(spent_log_itr);
+            budget.consume(erase_cost);
+        }
+        if (spent_log_itr != _spent_log.end()) {
+            break;
+        }
+        spent_state.pruned_height++;
+    }
+    _spent_state.set(spent_state, get_self());
+    return spent_state.pruned_height >= height;
+}
+
 void utxo_manage::save_pending_utxo(const uint64_t height, const checksum256& hash, const checksum256& txid,
                                     const uint32_t index, const std::vector<uint8_t>& script_data, const uint64_t value,
                                     const name& type) {
@@ -765,7 +1772,8 @@ void utxo_manage::save_pending_utxo(const uint64_t height, const checksum256& ha
 }
 
 utxo_manage::utxo_row utxo_manage::save_utxo(const checksum256& txid, const uint32_t index,
-                                             const std::vector<uint8_t>& script_data, const uint64_t value) {
+                                             const std::vector<uint8_t>& script_data, const uint64_t value,
+                                             xsat::muhash3072& utxo_set_hash) {
     //  save output
     auto id = _utxo.available_primary_key();
     if (id == 0) {
@@ -778,21 +1786,352 @@ utxo_manage::utxo_row utxo_manage::save_utxo(const checksum256& txid, const uint
         row.scriptpubkey = script_data;
         row.value = value;
     });
+    if (is_backfilled(id)) {
+        add_balance(script_data, value);
+        utxo_set_hash.insert(xsat::utils::compute_utxo_digest(txid, index, value, script_data));
+    }
     return *utxo_itr;
 }
 
 template <typename IDX>
 optional<utxo_manage::utxo_row> utxo_manage::remove_utxo(IDX& utxo_idx, const checksum256& prev_txid,
-                                                         const uint32_t prev_index) {
+                                                         const uint32_t prev_index, xsat::muhash3072& utxo_set_hash,
+                                                         const work_cost_row& work_cost, work_budget& budget) {
+    optional<utxo_row> found_utxo;
     auto utxo_itr = utxo_idx.find(xsat::utils::compute_utxo_id(prev_txid, prev_index));
     if (utxo_itr != utxo_idx.end()) {
-        auto found_utxo = *utxo_itr;
+        found_utxo = *utxo_itr;
         utxo_idx.erase(utxo_itr);
-        return found_utxo;
     } else {
-        // log
-        utxo_manage::lostutxolog_action _lostutxolog(get_self(), {get_self(), "active"_n});
-        _lostutxolog.send(prev_txid, prev_index);
+        // dormant utxos are only expanded when they are spent
+        found_utxo = remove_cold_utxo(prev_txid, prev_index, work_cost, budget);
+        if (!found_utxo.has_value()) {
+            return nullopt;
+        }
+    }
+    if (is_backfilled(found_utxo->id)) {
+        sub_balance(found_utxo->scriptpubkey, found_utxo->value);
+        utxo_set_hash.remove(
+            xsat::utils::compute_utxo_digest(prev_txid, prev_index, found_utxo->value, found_utxo->scriptpubkey));
+    }
+    return found_utxo;
+}
+
+uint64_t utxo_manage::get_cold_bucket(const checksum256& txid) {
+    auto bytes = txid.extract_as_byte_array();
+    uint64_t prefix = 0;
+    for (auto i = 0; i < 8; i++) {
+        prefix = (prefix << 8) | bytes[i];
+    }
+    return prefix >> (64 - COLD_UTXO_BUCKET_BITS);
+}
+
+uint64_t utxo_manage::get_cold_bucket_cost(const work_cost_row& work_cost, const cold_utxo_row& cold_utxo) {
+    // a bucket is read and rewritten as a whole, so it is charged by its size rather than per utxo
+    auto kbytes = (eosio::pack_size(cold_utxo) + 1023) / 1024;
+    return std::max<uint64_t>(work_cost.deserialize_kbytes, 1) * kbytes;
+}
+
+std::vector<uint8_t> utxo_manage::address_to_script(const string& address) {
+    std::vector<unsigned char> script;
+    string error;
+    check(bitcoin::DecodeDestination(address, script, CHAIN_PARAMS, error),
+          "4013:utxomng.xsat: invalid bitcoin address, " + error);
+    return script;
+}
+
+optional<utxo_manage::tx_proof> utxo_manage::generate_tx_proof(const uint64_t bucket_id,
+                                                               const checksum256& block_hash,
+                                                               const checksum256& merkle, const checksum256& txid) {
+    auto block_data = block_sync::read_bucket(BLOCK_SYNC_CONTRACT, bucket_id, BLOCK_CHUNK, BLOCK_HEADER_SIZE,
+                                              std::numeric_limits<uint64_t>::max());
+    eosio::datastream<const char*> block_stream(block_data.data(), block_data.size());
+
+    auto num_transactions = bitcoin::varint::decode(block_stream);
+    std::vector<bitcoin::uint256_t> hashes;
+    hashes.reserve(num_transactions);
+    optional<tx_proof> proof;
+    for (uint32_t index = 0; index < num_transactions; index++) {
+        bitcoin::core::transaction transaction(&block_data);
+        block_stream >> transaction;
+        hashes.push_back(transaction.merkle_hash());
+
+        if (!proof.has_value() && bitcoin::be_checksum256_from_uint(hashes.back()) == txid) {
+            proof = tx_proof{.block_hash = block_hash, .merkle = merkle, .index = index};
+            proof->raw_transaction.assign(block_data.begin() + transaction.from, block_data.begin() + transaction.to);
+        }
+    }
+    if (!proof.has_value()) {
+        return nullopt;
+    }
+
+    auto branch = bitcoin::generate_merkle_branch(hashes, proof->index);
+    check(bitcoin::compute_merkle_root_from_branch(hashes[proof->index], branch, proof->index)
+              == bitcoin::be_uint_from_checksum256(merkle),
+          "utxomng.xsat::gettxproof: merkle root mismatch");
+    for (const auto& sibling : branch) {
+        proof->branch.push_back(bitcoin::be_checksum256_from_uint(sibling));
+    }
+    return proof;
+}
+
+utxo_manage::utxo_row utxo_manage::unpack_utxo(const packed_utxo& packed) {
+    utxo_row utxo;
+    utxo.id = packed.id;
+    utxo.txid = packed.txid;
+    utxo.index = packed.index;
+    utxo.scriptpubkey = xsat::utils::decompress_script(packed.script);
+    utxo.value = packed.value;
+    return utxo;
+}
+
+optional<utxo_manage::utxo_row> utxo_manage::find_cold_utxo(const checksum256& txid, const uint32_t index) {
+    auto cold_utxo_itr = _cold_utxo.find(get_cold_bucket(txid));
+    if (cold_utxo_itr == _cold_utxo.end()) {
         return nullopt;
     }
+    for (const auto& packed : cold_utxo_itr->utxos) {
+        if (packed.index == index && packed.txid == txid) {
+            return unpack_utxo(packed);
+        }
+    }
+    return nullopt;
+}
+
+optional<utxo_manage::utxo_row> utxo_manage::remove_cold_utxo(const checksum256& txid, const uint32_t index,
+                                                              const work_cost_row& work_cost, work_budget& budget) {
+    auto cold_utxo_itr = _cold_utxo.find(get_cold_bucket(txid));
+    if (cold_utxo_itr == _cold_utxo.end()) {
+        return nullopt;
+    }
+    budget.consume(get_cold_bucket_cost(work_cost, *cold_utxo_itr));
+
+    const auto& utxos = cold_utxo_itr->utxos;
+    auto packed_itr = std::find_if(utxos.begin(), utxos.end(), [&](const packed_utxo& packed) {
+        return packed.index == index && packed.txid == txid;
+    });
+    if (packed_itr == utxos.end()) {
+        return nullopt;
+    }
+
+    auto utxo = unpack_utxo(*packed_itr);
+    count_cold_utxo(utxo.scriptpubkey, false);
+    auto offset = packed_itr - utxos.begin();
+    if (utxos.size() == 1) {
+        _cold_utxo.erase(cold_utxo_itr);
+    } else {
+        _cold_utxo.modify(cold_utxo_itr, same_payer, [&](auto& row) {
+            row.utxos.erase(row.utxos.begin() + offset);
+        });
+    }
+    return utxo;
+}
+
+void utxo_manage::freeze_utxos(const work_cost_row& work_cost, work_budget& budget) {
+    // the backfill only scans `utxos`, so nothing is moved until it has completed
+    if (!budget.available() || !_cold_tier.exists() || !_backfill.get_or_default().completed)
+        return;
+
+    auto cold_tier = _cold_tier.get();
+    auto next_id = _utxo.available_primary_key();
+    if (cold_tier.retained_hot_utxos == 0 || next_id <= cold_tier.retained_hot_utxos)
+        return;
+
+    // utxo ids only grow, so the lowest ids are the utxos that have been dormant the longest
+    auto frozen_end = next_id - cold_tier.retained_hot_utxos;
+    auto remove_cost = std::max<uint64_t>(work_cost.remove_utxo, 1);
+    std::map<uint64_t, std::vector<packed_utxo>> buckets;
+    uint32_t num_frozen = 0;
+    auto utxo_itr = _utxo.begin();
+    while (utxo_itr != _utxo.end() && utxo_itr->id < frozen_end && num_frozen < cold_tier.max_frozen_utxos
+           && budget.available()) {
+        buckets[get_cold_bucket(utxo_itr->txid)].push_back(
+            packed_utxo{utxo_itr->id, utxo_itr->txid, utxo_itr->index, utxo_itr->value,
+                        xsat::utils::compress_script(utxo_itr->scriptpubkey)});
+        count_cold_utxo(utxo_itr->scriptpubkey, true);
+        cold_tier.frozen_id = utxo_itr->id + 1;
+        utxo_itr = _utxo.erase(utxo_itr);
+        budget.consume(remove_cost);
+        num_frozen++;
+    }
+    if (buckets.empty())
+        return;
+
+    // each packed row is rewritten once per call
+    for (auto& [bucket, utxos] : buckets) {
+        auto cold_utxo_itr = _cold_utxo.find(bucket);
+        if (cold_utxo_itr == _cold_utxo.end()) {
+            cold_utxo_itr = _cold_utxo.emplace(get_self(), [&](auto& row) {
+                row.bucket = bucket;
+                row.utxos = std::move(utxos);
+            });
+        } else {
+            _cold_utxo.modify(cold_utxo_itr, same_payer, [&](auto& row) {
+                row.utxos.insert(row.utxos.end(), utxos.begin(), utxos.end());
+            });
+        }
+        budget.consume(get_cold_bucket_cost(work_cost, *cold_utxo_itr));
+    }
+    _cold_tier.set(cold_tier, get_self());
+}
+
+void utxo_manage::record_stage(const uint64_t height, const checksum256& hash, const pipeline_stage stage,
+                               const uint64_t num_rows) {
+    time_point_sec now = current_time_point();
+    auto pipeline_stats = _pipeline_stats.get_or_default();
+    pipeline_stats.stages.resize(NUM_PIPELINE_STAGES);
+    auto& metric = pipeline_stats.stages[stage];
+    metric.calls += 1;
+
+    // Only the first time a block reaches a stage is recorded
+    auto block_timeline_idx = _block_timeline.get_index<"byblockid"_n>();
+    auto block_timeline_itr = block_timeline_idx.find(xsat::utils::compute_block_id(height, hash));
+    optional<time_point_sec> previous_time;
+    if (block_timeline_itr == block_timeline_idx.end()) {
+        _block_timeline.emplace(get_self(), [&](auto& row) {
+            row.id = _block_timeline.available_primary_key();
+            row.height = height;
+            row.hash = hash;
+            row.stage_times.resize(NUM_PIPELINE_STAGES);
+            row.stage_times[stage] = now;
+            row.num_rows = num_rows;
+        });
+    } else if (block_timeline_itr->stage_times[stage] == time_point_sec()) {
+        for (const auto& stage_time : block_timeline_itr->stage_times) {
+            if (stage_time != time_point_sec() && (!previous_time.has_value() || stage_time > *previous_time)) {
+                previous_time = stage_time;
+            }
+        }
+        block_timeline_idx.modify(block_timeline_itr, same_payer, [&](auto& row) {
+            row.stage_times[stage] = now;
+            if (num_rows > 0) {
+                row.num_rows = num_rows;
+            }
+        });
+    } else {
+        _pipeline_stats.set(pipeline_stats, get_self());
+        return;
+    }
+
+    // rolling averages weighted over the last PIPELINE_METRICS_WINDOW samples
+    auto rolling_average = [](const uint64_t average, const uint64_t value, const uint64_t samples) {
+        return samples == 1 ? value : (average * (PIPELINE_METRICS_WINDOW - 1) + value) / PIPELINE_METRICS_WINDOW;
+    };
+    metric.samples += 1;
+    if (previous_time.has_value()) {
+        auto seconds = now.sec_since_epoch() - previous_time->sec_since_epoch();
+        metric.avg_seconds = rolling_average(metric.avg_seconds, seconds, metric.samples);
+    }
+    if (stage == stage_migration_done) {
+        pipeline_stats.num_blocks += 1;
+        pipeline_stats.avg_rows_per_block
+            = rolling_average(pipeline_stats.avg_rows_per_block, num_rows, pipeline_stats.num_blocks);
+    }
+    _pipeline_stats.set(pipeline_stats, get_self());
+}
+
+bool utxo_manage::is_backfilled(const uint64_t utxo_id) {
+    if (!_backfill.exists()) {
+        return false;
+    }
+    auto backfill = _backfill.get();
+    return backfill.completed || utxo_id < backfill.next_id || utxo_id >= backfill.end_id;
+}
+
+void utxo_manage::backfill_utxos(const work_cost_row& work_cost, work_budget& budget) {
+    if (!budget.available() || !_backfill.exists())
+        return;
+
+    auto backfill = _backfill.get();
+    if (backfill.completed)
+        return;
+
+    auto save_cost = std::max<uint64_t>(work_cost.save_utxo, 1);
+    auto utxo_set_hash = get_utxo_set_hash();
+    auto utxo_itr = _utxo.lower_bound(backfill.next_id);
+    while (utxo_itr != _utxo.end() && utxo_itr->id < backfill.end_id && budget.available()) {
+        add_balance(utxo_itr->scriptpubkey, utxo_itr->value);
+        utxo_set_hash.insert(xsat::utils::compute_utxo_digest(utxo_itr->txid, utxo_itr->index, utxo_itr->value,
+                                                               utxo_itr->scriptpubkey));
+        backfill.next_id = utxo_itr->id + 1;
+        utxo_itr++;
+        budget.consume(save_cost);
+    }
+    backfill.completed = utxo_itr == _utxo.end() || utxo_itr->id >= backfill.end_id;
+    _backfill.set(backfill, get_self());
+    save_utxo_set_hash(utxo_set_hash);
+}
+
+xsat::muhash3072 utxo_manage::get_utxo_set_hash() {
+    auto utxo_set = _utxo_set.get_or_default();
+    return xsat::muhash3072(utxo_set.numerator, utxo_set.denominator);
+}
+
+void utxo_manage::save_utxo_set_hash(const xsat::muhash3072& utxo_set_hash) {
+    auto utxo_set = _utxo_set.get_or_default();
+    utxo_set.numerator = utxo_set_hash.numerator_bytes();
+    utxo_set.denominator = utxo_set_hash.denominator_bytes();
+    _utxo_set.set(utxo_set, get_self());
+}
+
+void utxo_manage::add_balance(const std::vector<uint8_t>& scriptpubkey, const uint64_t value) {
+    auto balance_idx = _balance.get_index<"scripthash"_n>();
+    auto scripthash = xsat::utils::hash(scriptpubkey);
+    auto balance_itr = balance_idx.find(scripthash);
+    if (balance_itr == balance_idx.end()) {
+        _balance.emplace(get_self(), [&](auto& row) {
+            row.id = _balance.available_primary_key();
+            row.scripthash = scripthash;
+            row.value = value;
+            row.num_utxos = 1;
+        });
+    } else {
+        balance_idx.modify(balance_itr, same_payer, [&](auto& row) {
+            row.value += value;
+            row.num_utxos += 1;
+        });
+    }
+}
+
+void utxo_manage::sub_balance(const std::vector<uint8_t>& scriptpubkey, const uint64_t value) {
+    auto balance_idx = _balance.get_index<"scripthash"_n>();
+    auto balance_itr = balance_idx.require_find(xsat::utils::hash(scriptpubkey),
+                                                "utxomng.xsat: [balances] does not exist");
+    if (balance_itr->num_utxos == 1) {
+        balance_idx.erase(balance_itr);
+    } else {
+        balance_idx.modify(balance_itr, same_payer, [&](auto& row) {
+            row.value -= value;
+            row.num_utxos -= 1;
+        });
+    }
+}
+
+// Frozen utxos keep their balance, the count only tells `utxosbyscrpt` that the script has unlisted utxos
+void utxo_manage::count_cold_utxo(const std::vector<uint8_t>& scriptpubkey, const bool frozen) {
+    auto balance_idx = _balance.get_index<"scripthash"_n>();
+    auto balance_itr = balance_idx.require_find(xsat::utils::hash(scriptpubkey),
+                                                "utxomng.xsat: [balances] does not exist");
+    balance_idx.modify(balance_itr, same_payer, [&](auto& row) {
+        auto num_cold_utxos = row.num_cold_utxos.value_or(0);
+        row.num_cold_utxos = frozen ? num_cold_utxos + 1 : num_cold_utxos - 1;
+    });
+}
+
+optional<utxo_manage::utxo_row> utxo_manage::remove_pending_vout(const utxo_manage::pending_utxo_row& vin) {
+    auto block_utxo_id = compute_utxo_id_for_block(vin.height, vin.hash, vin.txid, vin.index);
+    auto pending_utxo_idx = _pending_utxo.get_index<"byblkutxoid"_n>();
+    auto pending_utxo_itr = pending_utxo_idx.lower_bound(block_utxo_id);
+    for (; pending_utxo_itr != pending_utxo_idx.end() && pending_utxo_itr->by_block_utxo_id() == block_utxo_id;
+         pending_utxo_itr++) {
+        if (pending_utxo_itr->type == "vout"_n) {
+            auto found_utxo = utxo_row{.txid = pending_utxo_itr->txid,
+                                       .index = pending_utxo_itr->index,
+                                       .scriptpubkey = pending_utxo_itr->scriptpubkey,
+                                       .value = pending_utxo_itr->value};
+            pending_utxo_idx.erase(pending_utxo_itr);
+            return found_utxo;
+        }
+    }
+    return nullopt;
 }
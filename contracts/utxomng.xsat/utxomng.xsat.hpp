@@ -4,8 +4,10 @@
 #include <eosio/eosio.hpp>
 #include <eosio/singleton.hpp>
 #include <eosio/crypto.hpp>
+#include <eosio/binary_extension.hpp>
 #include "../internal/defines.hpp"
 #include "../internal/utils.hpp"
+#include "../internal/muhash.hpp"
 
 using namespace eosio;
 using namespace std;
@@ -40,6 +42,23 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         }
     }
 
+    // migrating, deleting_data and distributing_rewards of the irreversible block run independently of parsing
+    static bool is_migration_phase(const parsing_status status) {
+        return status == migrating || status == deleting_data || status == distributing_rewards;
+    }
+
+    typedef uint8_t pipeline_stage;
+    static const pipeline_stage stage_bucket_init = 0;
+    static const pipeline_stage stage_upload_complete = 1;
+    static const pipeline_stage stage_verify_pass = 2;
+    static const pipeline_stage stage_btc_quorum = 3;
+    static const pipeline_stage stage_xsat_quorum = 4;
+    static const pipeline_stage stage_parse_start = 5;
+    static const pipeline_stage stage_parse_end = 6;
+    static const pipeline_stage stage_migration_done = 7;
+    static const pipeline_stage stage_irreversible = 8;
+    static const uint8_t NUM_PIPELINE_STAGES = 9;
+
     /**
      * ## STRUCT `parsing_progress_row`
      *
@@ -51,7 +70,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
      * - `{uint64_t} parsed_position` - the position of the currently parsed block
      * - `{uint64_t} parsed_vin` - the current transaction has been resolved to the vin index
      * - `{uint64_t} parsed_vout` - the current transaction has been resolved to the vout index
-     * - `{name} parser` - the last parser of the parsing block
+     * - `{name} parser` - the last parser of the parsing block, empty if the block is parsed in shards @see `parseshards`
      * - `{time_point_sec} parsed_expiration_time` - timeout for parsing chunks
      *
      * ### example
@@ -79,6 +98,8 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         uint64_t parsed_vout;
         name parser;
         time_point_sec parse_expiration_time;
+
+        bool is_sharded() const { return !parser.value && parsed_position > 0; }
     };
 
     /**
@@ -87,36 +108,37 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
      * ### scope `get_self()`
      * ### params
      *
-     * - `{uint64_t} num_utxos` - total number of UTXOs
+     * - `{uint64_t} num_utxos` - deprecated and always 0, @see `chaincursor`
      * - `{uint64_t} head_height` - header block height for consensus success
      * - `{uint64_t} irreversible_height` - irreversible block height
      * - `{uint64_t} irreversible_hash` - irreversible block hash
      * - `{uint64_t} migrating_height` - block height in migration
      * - `{uint64_t} migrating_hash` - block hash in migration
      * - `{uint64_t} migrating_num_utxos` - the total number of UTXOs in the migration
-     * - `{uint64_t} migrated_num_utxos` - number of UTXOs that have been migrated
+     * - `{uint64_t} migrated_num_utxos` - deprecated and always 0, @see `chaincursor`
      * - `{uint32_t} num_provider_validators` - the number of validators that have endorsed the current parsed block
-     * - `{uint32_t} num_validators_assigned` - the number of validators that have been allocated rewards
+     * - `{uint32_t} num_validators_assigned` - deprecated and always 0, @see `chaincursor`
      * - `{name} miner` - block miner account
      * - `{name} synchronizer` - block synchronizer account
      * - `{name} parser` - the account number of the parsing block
      * - `{uint64_t} parsed_height` - parsed block height
      * - `{uint64_t} parsing_height` - the current height being parsed
-     * - `{map<checksum256, parsing_progress_row>} parsing_progress_of` - parsing progress @see `parsing_progress_row`
-     * - `{uint8_t} status` - parsing status @see `parsing_status`
+     * - `{map<checksum256, parsing_progress_row>} parsing_progress_of` - deprecated and always empty, the parsing progress
+     * is stored in `parsingblks`
+     * - `{uint8_t} status` - deprecated and always 0, @see `chaincursor`
      *
      * ### example
      *
      * ```json
      * {
-     *   "num_utxos": 26240,
+     *   "num_utxos": 0,
      *   "head_height": 840031,
      *   "irreversible_height": 840002,
      *   "irreversible_hash": "00000000000000000002c0cc73626b56fb3ee1ce605b0ce125cc4fb58775a0a9",
      *   "migrating_height": 840003,
      *   "migrating_hash": "00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119",
      *   "migrating_num_utxos": 16278,
-     *   "migrated_num_utxos": 10000,
+     *   "migrated_num_utxos": 0,
      *   "num_provider_validators": 2,
      *   "num_validators_assigned": 0,
      *   "miner": "",
@@ -124,22 +146,8 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
      *   "parser": "alice",
      *   "parsed_height": 840008,
      *   "parsing_height": 840009,
-     *   "parsing_progress_of": [{
-     *       "first": "00000000000000000000c6075e66b667adcdb8935e6d9a877f5cf140c806ae87",
-     *       "second": {
-     *           "bucket_id": 11,
-     *           "num_utxos": 0,
-     *           "num_transactions": 0,
-     *           "parsed_transactions": 0,
-     *           "parsed_position": 0,
-     *           "parsed_vin": 0,
-     *           "parsed_vout": 0,
-     *           "parser": "alice",
-     *           "parse_expiration_time": "2024-08-08T02:44:43"
-     *       }
-     *       }
-     *   ],
-     *   "status": 5
+     *   "parsing_progress_of": [],
+     *   "status": 0
      * }
      * ```
      */
@@ -164,6 +172,39 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     };
     typedef eosio::singleton<"chainstate"_n, chain_state_row> chain_state_table;
 
+    /**
+     * ## TABLE `chaincursor`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} num_utxos` - total number of UTXOs
+     * - `{uint64_t} migrated_num_utxos` - number of UTXOs that have been migrated
+     * - `{uint32_t} num_validators_assigned` - the number of validators that have been allocated rewards
+     * - `{uint8_t} status` - parsing status @see `parsing_status`
+     *
+     * > The fields of `chainstate` that change on every `processblock` call, `chainstate` itself is only rewritten
+     * when a block moves to its next stage.
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "num_utxos": 26240,
+     *   "migrated_num_utxos": 10000,
+     *   "num_validators_assigned": 0,
+     *   "status": 5
+     * }
+     * ```
+     */
+    struct [[eosio::table]] chain_cursor_row {
+        uint64_t num_utxos;
+        uint64_t migrated_num_utxos;
+        uint32_t num_validators_assigned;
+        parsing_status status;
+    };
+    typedef eosio::singleton<"chaincursor"_n, chain_cursor_row> chain_cursor_table;
+
     /**
      * ## TABLE `config`
      *
@@ -178,6 +219,8 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
      * - `{uint8_t} num_merkle_layer` - verify the number of merkle levels (log(num_txs_per_verification))
      * - `{uint16_t} num_miner_priority_blocks` - miners who produce blocks give priority to verifying the number of
      * blocks
+     * - `{binary_extension<uint32_t>} num_txs_per_shard` - blocks with more transactions are split into shards of this
+     * size that can be parsed by different synchronizers, 0 disables sharding
      *
      * ### example
      *
@@ -189,7 +232,8 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
      *   "retained_spent_utxo_blocks": 5000,
      *   "num_txs_per_verification": 1024,
      *   "num_merkle_layer": 10,
-     *   "num_miner_priority_blocks": 10
+     *   "num_miner_priority_blocks": 10,
+     *   "num_txs_per_shard": 500
      *  }
      * ```
      */
@@ -201,9 +245,55 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         uint16_t num_txs_per_verification = 2048;
         uint8_t num_merkle_layer = 11;
         uint16_t num_miner_priority_blocks = 10;
+
+        binary_extension<uint32_t> num_txs_per_shard;
+
+        uint32_t get_num_txs_per_shard() const { return num_txs_per_shard.has_value() ? num_txs_per_shard.value() : 0; }
     };
     typedef eosio::singleton<"config"_n, config_row> config_table;
 
+    /**
+     * ## TABLE `workcost`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} budget` - maximum cost units consumed by each `processblock` call, 0 means the `process_rows` passed
+     * by the caller is used as is
+     * - `{uint32_t} pending_emplace` - cost of parsing a vin/vout into `pendingutxos`
+     * - `{uint32_t} remove_utxo` - cost of removing a spent utxo from `utxos`
+     * - `{uint32_t} save_utxo` - cost of saving a new utxo to `utxos`
+     * - `{uint32_t} save_spent_utxo` - cost of recording a spent utxo in `spentlog`
+     * - `{uint32_t} pending_erase` - cost of erasing a `pendingutxos` row (also applied to other row deletions)
+     * - `{uint32_t} deserialize_kbytes` - cost of deserializing 1024 bytes of transaction data
+     *
+     * > The defaults charge one unit per parsed or migrated row, which is the same as counting rows.
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "budget": 20000,
+     *   "pending_emplace": 10,
+     *   "remove_utxo": 12,
+     *   "save_utxo": 10,
+     *   "save_spent_utxo": 6,
+     *   "pending_erase": 6,
+     *   "deserialize_kbytes": 4
+     * }
+     * ```
+     */
+    struct [[eosio::table]] work_cost_row {
+        uint64_t budget = 0;
+        uint32_t pending_emplace = 1;
+        uint32_t remove_utxo = 0;
+        uint32_t save_utxo = 0;
+        uint32_t save_spent_utxo = 0;
+        uint32_t pending_erase = 1;
+        uint32_t deserialize_kbytes = 0;
+    };
+    typedef eosio::singleton<"workcost"_n, work_cost_row> work_cost_table;
+
     /**
      * ## TABLE `utxos`
      *
@@ -244,6 +334,71 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         eosio::indexed_by<"byutxoid"_n, const_mem_fun<utxo_row, checksum256, &utxo_row::by_utxo_id>>>
         utxo_table;
 
+    /**
+     * ## TABLE `balances`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - primary key
+     * - `{checksum256} scripthash` - sha256 of the scriptpubkey, same as the `scriptpubkey` index of `utxos`
+     * - `{uint64_t} value` - total value of the utxos locked by the scriptpubkey
+     * - `{uint64_t} num_utxos` - number of utxos locked by the scriptpubkey
+     * - `{binary_extension<uint64_t>} num_cold_utxos` - number of those utxos that have been moved to `coldutxos`
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 1,
+     *   "scripthash": "68616b4e3a395a51a095185b74890179a530268e0d43bc148c98f19e4aafe449",
+     *   "value": 4075061499,
+     *   "num_utxos": 3,
+     *   "num_cold_utxos": 1
+     * }
+     * ```
+     */
+    struct [[eosio::table]] balance_row {
+        uint64_t id;
+        checksum256 scripthash;
+        uint64_t value;
+        uint64_t num_utxos;
+        binary_extension<uint64_t> num_cold_utxos;
+        uint64_t primary_key() const { return id; }
+        checksum256 by_scripthash() const { return scripthash; }
+    };
+    typedef eosio::multi_index<
+        "balances"_n, balance_row,
+        eosio::indexed_by<"scripthash"_n, const_mem_fun<balance_row, checksum256, &balance_row::by_scripthash>>>
+        balance_table;
+
+    /**
+     * ## TABLE `backfill`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} end_id` - `utxos` saved with an id from this value onwards are indexed when they are saved
+     * - `{uint64_t} next_id` - `utxos` with an id less than this value have been folded into the index
+     * - `{bool} completed` - whether every utxo saved before `initbackfill` has been folded into the index
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "end_id": 180000000,
+     *   "next_id": 2500000,
+     *   "completed": false
+     * }
+     * ```
+     */
+    struct [[eosio::table]] backfill_row {
+        uint64_t end_id;
+        uint64_t next_id;
+        bool completed;
+    };
+    typedef eosio::singleton<"backfill"_n, backfill_row> backfill_table;
+
     /**
      * ## TABLE `pendingutxos`
      *
@@ -350,238 +505,1043 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         spent_utxo_table;
 
     /**
-     * ## TABLE `blocks`
+     * ## TABLE `spentlog`
+     *
+     * ### scope `height`
+     * ### params
+     *
+     * - `{uint64_t} id` - primary key
+     * - `{checksum256} txid` - transaction id
+     * - `{uint32_t} index` - vout index
+     * - `{std::vector<uint8_t>} script` - compressed script public key @see `xsat::utils::compress_script`
+     * - `{uint64_t} value` - utxo quantity
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 0,
+     *   "txid": "2bb85f4b004be6da54f766c17c1e855187327112c231ef2ff35ebad0ea67c69e",
+     *   "index": 0,
+     *   "script": "043b8b3ab1453eb47e2d4903b963776680e30863df3625d3e74292338ae7928da1",
+     *   "value": 1797928002
+     * }
+     * ```
+     */
+    struct [[eosio::table]] spent_log_row {
+        uint64_t id;
+        checksum256 txid;
+        uint32_t index;
+        std::vector<uint8_t> script;
+        uint64_t value;
+        uint64_t primary_key() const { return id; }
+    };
+    typedef eosio::multi_index<"spentlog"_n, spent_log_row> spent_log_table;
+
+    /**
+     * ## TABLE `spentstate`
      *
      * ### scope `get_self()`
      * ### params
      *
-     * - `{uint64_t} height` - block height
-     * - `{checksum256} hash` - block hash
-     * - `{checksum256} cumulative_work` - the cumulative workload of the block
-     * - `{uint32_t} version` - block version
-     * - `{checksum256} previous_block_hash` - hash in internal byte order of the previous block’s header
-     * - `{checksum256} merkle` - the merkle root is derived from the hashes of all transactions included in this block
-     * - `{uint32_t} timestamp` - the block time is a Unix epoch time
-     * - `{uint32_t} bits` - an encoded version of the target threshold this block’s header hash must be less than or equal to
-     * - `{uint32_t} nonce` - an arbitrary number miners change to modify the header hash in order to produce a hash less than or
+     * - `{uint64_t} pruned_height` - all `spentlog` scopes less than or equal to this height have been reclaimed
      *
      * ### example
      *
      * ```json
      * {
-     *   "height": 840011,
-     *   "hash": "00000000000000000002d12efb02bcf70580b2eebf4b775578844640512e30f3",
-     *   "cumulative_work": "0000000000000000000000000000000000000000753f3af9322a2a893cb6ece4",
-     *   "version": 747323392,
-     *   "previous_block_hash": "00000000000000000000da20f7d8e9e6412d4f1d8b62d88264cddbdd48256ba0",
-     *   "merkle": "476eac37dd22a59952c5812f715a3e39b68663e40d80d756ba44d7d59e7d6a0a",
-     *   "timestamp": 1713576761,
-     *   "bits": 386089497,
-     *   "nonce": 1492849681
-     *  }
+     *   "pruned_height": 835000
+     * }
      * ```
      */
-    struct [[eosio::table]] block_row {
-        uint64_t height;
-        checksum256 hash;
-        checksum256 cumulative_work;
-        uint32_t version;
-        checksum256 previous_block_hash;
-        checksum256 merkle;
-        uint32_t timestamp;
-        uint32_t bits;
-        uint32_t nonce;
-        uint64_t primary_key() const { return height; }
-        checksum256 by_hash() const { return hash; }
+    struct [[eosio::table]] spent_state_row {
+        uint64_t pruned_height;
     };
-    typedef eosio::multi_index<
-        "blocks"_n, block_row,
-        eosio::indexed_by<"byhash"_n, const_mem_fun<block_row, checksum256, &block_row::by_hash>>>
-        block_table;
+    typedef eosio::singleton<"spentstate"_n, spent_state_row> spent_state_table;
 
     /**
-     * ## TABLE `block.extra`
+     * ## TABLE `utxoset`
      *
      * ### scope `get_self()`
      * ### params
      *
-     * - `{uint64_t} height` - block height
-     * - `{uint64_t} bucket_id` - the associated bucket number is used to obtain block data
+     * - `{checksum256} commitment` - MuHash3072 commitment of all utxos in `utxos` and `coldutxos`, sha256 of
+     * numerator / denominator, published for every migrated block once the backfill has completed @see `backfill`
+     * - `{std::vector<uint8_t>} numerator` - product modulo 2^3072 - 1103717 of the elements of all saved utxos, 384
+     * bytes little-endian, the element of a utxo is sha256(digest || i) for i in 0..11 read as a little-endian number
+     * and digest is sha256(txid || index || value || scriptpubkey)
+     * - `{std::vector<uint8_t>} denominator` - product of the elements of all spent utxos
      *
      * ### example
      *
      * ```json
      * {
-     *   "height": 840001,
-     *   "bucket_id": 1
+     *   "commitment": "7bd0fc1b52bcf8e1c0b1b8a7d2c2a1d3fce0a7a6a1e39f18ae1f1bb0ec7e0e3c",
+     *   "numerator": "3f0c...e901",
+     *   "denominator": "a21b...7c04"
      * }
      * ```
      */
-    struct [[eosio::table]] block_extra_row {
-        uint64_t height;
-        uint64_t bucket_id;
-        uint64_t primary_key() const { return height; }
+    struct [[eosio::table]] utxo_set_row {
+        checksum256 commitment;
+        std::vector<uint8_t> numerator;
+        std::vector<uint8_t> denominator;
     };
-    typedef eosio::multi_index<"block.extra"_n, block_extra_row> block_extra_table;
+    typedef eosio::singleton<"utxoset"_n, utxo_set_row> utxo_set_table;
 
     /**
-     * ## TABLE `consensusblk`
+     * ## TABLE `coldtier`
      *
      * ### scope `get_self()`
      * ### params
      *
-     * - `{uint64_t} bucket_id` - the associated bucket number is used to obtain block data
-     * - `{uint64_t} height` - block height
-     * - `{checksum256} hash` - block hash
-     * - `{checksum256} cumulative_work` - the cumulative workload of the block
-     * - `{uint32_t} version` - block version
-     * - `{checksum256} previous_block_hash` - hash in internal byte order of the previous block’s header
-     * - `{checksum256} merkle` - the merkle root is derived from the hashes of all transactions included in this block
-     * - `{uint32_t} timestamp` - the block time is a Unix epoch time
-     * - `{uint32_t} bits` - an encoded version of the target threshold this block’s header hash must be less than or equal to
-     * - `{uint32_t} nonce` - an arbitrary number miners change to modify the header hash in order to produce a hash less than or
-     * - `{name} miner` - block miner account
-     * - `{name} synchronizer` - block synchronizer account
-     * - `{name} parser` - the last parser of the parsing block
-     * - `{uint64_t} num_utxos` - the total number of vin and vout of the block
-     * - `{bool} parse` - is it an parsed block
-     * - `{bool} irreversible` - is it an irreversible block
-     * - `{time_point_sec} created_at` - created at time
+     * - `{uint64_t} retained_hot_utxos` - number of most recently created utxos kept in `utxos`, older ones are moved
+     * into `coldutxos`, 0 disables it
+     * - `{uint32_t} max_frozen_utxos` - maximum number of utxos moved by each `processblock` call
+     * - `{uint64_t} frozen_id` - all utxos in `utxos` with an id less than this value have been moved
      *
      * ### example
      *
      * ```json
      * {
-     *   "bucket_id": 5,
-     *   "height": 840003,
-     *   "hash": "00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119",
-     *   "cumulative_work": "0000000000000000000000000000000000000000753cc66782a80f6f099fe68c",
-     *   "version": 704643072,
-     *   "previous_block_hash": "00000000000000000002c0cc73626b56fb3ee1ce605b0ce125cc4fb58775a0a9",
-     *   "merkle": "2daee999cac85a7663bbc3a0e24bd7c86e009c005e7d801ef104d134b420179b",
-     *   "timestamp": 1713572633,
-     *   "bits": 386089497,
-     *   "nonce": 213198539,
-     *   "miner": "",
-     *   "synchronizer": "alice",
-     *   "parser": "alice",
-     *   "num_utxos": 16278,
-     *   "parse": 1,
-     *   "irreversible": 1,
-     *   "created_at": "2024-08-13T00:00:00"
+     *   "retained_hot_utxos": 20000000,
+     *   "max_frozen_utxos": 500,
+     *   "frozen_id": 160000000
      * }
      * ```
      */
-    struct [[eosio::table]] consensus_block_row {
-        uint64_t bucket_id;
-        uint64_t height;
-        checksum256 hash;
-        checksum256 cumulative_work;
-        uint32_t version;
-        checksum256 previous_block_hash;
-        checksum256 merkle;
-        uint32_t timestamp;
-        uint32_t bits;
-        uint32_t nonce;
-        name miner;
-        name synchronizer;
-        name parser;
-        uint64_t num_utxos;
-        bool irreversible;
-        bool parse;
-        time_point_sec created_at;
-        uint64_t primary_key() const { return bucket_id; }
-        uint64_t by_height() const { return height; }
-        uint64_t by_synchronizer() const { return synchronizer.value; }
-        uint128_t by_parse_height() const { return compute_parse_height(parse, height); }
-        checksum256 by_block_id() const { return xsat::utils::compute_block_id(height, hash); }
+    struct [[eosio::table]] cold_tier_row {
+        uint64_t retained_hot_utxos;
+        uint32_t max_frozen_utxos;
+        uint64_t frozen_id;
     };
-    typedef eosio::multi_index<
-        "consensusblk"_n, consensus_block_row,
-        eosio::indexed_by<"byheight"_n, const_mem_fun<consensus_block_row, uint64_t, &consensus_block_row::by_height>>,
-        eosio::indexed_by<"bysyncer"_n,
-                          const_mem_fun<consensus_block_row, uint64_t, &consensus_block_row::by_synchronizer>>,
-        eosio::indexed_by<"parseheight"_n,
-                          const_mem_fun<consensus_block_row, uint128_t, &consensus_block_row::by_parse_height>>,
-        eosio::indexed_by<"byblockid"_n,
-                          const_mem_fun<consensus_block_row, checksum256, &consensus_block_row::by_block_id>>>
-        consensus_block_table;
+    typedef eosio::singleton<"coldtier"_n, cold_tier_row> cold_tier_table;
+
+    /**
+     * ## STRUCT `packed_utxo`
+     *
+     * ### params
+     *
+     * - `{uint64_t} id` - id of the utxo in `utxos` before it was moved
+     * - `{checksum256} txid` - transaction id
+     * - `{uint32_t} index` - vout index
+     * - `{uint64_t} value` - utxo quantity
+     * - `{std::vector<uint8_t>} script` - compressed script public key @see `xsat::utils::compress_script`
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 2,
+     *   "txid": "2bb85f4b004be6da54f766c17c1e855187327112c231ef2ff35ebad0ea67c69e",
+     *   "index": 0,
+     *   "value": 1797928002,
+     *   "script": "043b8b3ab1453eb47e2d4903b963776680e30863df3625d3e74292338ae7928da1"
+     * }
+     * ```
+     */
+    struct packed_utxo {
+        uint64_t id;
+        checksum256 txid;
+        uint32_t index;
+        uint64_t value;
+        std::vector<uint8_t> script;
+    };
+
+    /**
+     * ## TABLE `coldutxos`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} bucket` - primary key, the first `COLD_UTXO_BUCKET_BITS` bits of the txid
+     * - `{std::vector<packed_utxo>} utxos` - dormant utxos whose txid starts with the bucket prefix, a utxo is only
+     * expanded when it is spent
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "bucket": 2865247,
+     *   "utxos": [{
+     *     "id": 2,
+     *     "txid": "2bb85f4b004be6da54f766c17c1e855187327112c231ef2ff35ebad0ea67c69e",
+     *     "index": 0,
+     *     "value": 1797928002,
+     *     "script": "043b8b3ab1453eb47e2d4903b963776680e30863df3625d3e74292338ae7928da1"
+     *   }]
+     * }
+     * ```
+     */
+    struct [[eosio::table]] cold_utxo_row {
+        uint64_t bucket;
+        std::vector<packed_utxo> utxos;
+        uint64_t primary_key() const { return bucket; }
+    };
+    typedef eosio::multi_index<"coldutxos"_n, cold_utxo_row> cold_utxo_table;
+
+    /**
+     * ## TABLE `timelines`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - primary key
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{std::vector<time_point_sec>} stage_times` - first time each `pipeline_stage` was reached, indexed by stage,
+     * zero if not reached yet
+     * - `{uint64_t} num_rows` - number of utxo rows migrated for the block
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 0,
+     *   "height": 840000,
+     *   "hash": "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5",
+     *   "stage_times": ["2024-07-13T14:29:32", "2024-07-13T14:29:50", "2024-07-13T14:30:02", "2024-07-13T14:30:15",
+     *                   "2024-07-13T14:30:21", "2024-07-13T14:30:27", "2024-07-13T14:31:40", "2024-07-13T15:32:05",
+     *                   "2024-07-13T15:32:11"],
+     *   "num_rows": 12043
+     * }
+     * ```
+     */
+    struct [[eosio::table]] block_timeline_row {
+        uint64_t id;
+        uint64_t height;
+        checksum256 hash;
+        std::vector<time_point_sec> stage_times;
+        uint64_t num_rows;
+        uint64_t primary_key() const { return id; }
+        uint64_t by_height() const { return height; }
+        checksum256 by_block_id() const { return xsat::utils::compute_block_id(height, hash); }
+    };
+    typedef eosio::multi_index<
+        "timelines"_n, block_timeline_row,
+        eosio::indexed_by<"byheight"_n, const_mem_fun<block_timeline_row, uint64_t, &block_timeline_row::by_height>>,
+        eosio::indexed_by<"byblockid"_n,
+                          const_mem_fun<block_timeline_row, checksum256, &block_timeline_row::by_block_id>>>
+        block_timeline_table;
+
+    /**
+     * ## STRUCT `stage_metric`
+     *
+     * ### params
+     *
+     * - `{uint64_t} calls` - number of times the stage was reported, including repeated reports of a block
+     * - `{uint64_t} samples` - number of blocks that reached the stage
+     * - `{uint32_t} avg_seconds` - rolling average of seconds since the previous reached stage of the same block
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "calls": 2310,
+     *   "samples": 1050,
+     *   "avg_seconds": 12
+     * }
+     * ```
+     */
+    struct stage_metric {
+        uint64_t calls;
+        uint64_t samples;
+        uint32_t avg_seconds;
+    };
+
+    /**
+     * ## TABLE `pipestats`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{std::vector<stage_metric>} stages` - metrics of each `pipeline_stage`, indexed by stage
+     * - `{uint64_t} num_blocks` - number of migrated blocks
+     * - `{uint64_t} avg_rows_per_block` - rolling average of utxo rows migrated per block
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "stages": [{"calls": 2310, "samples": 1050, "avg_seconds": 0}, ...],
+     *   "num_blocks": 1040,
+     *   "avg_rows_per_block": 11620
+     * }
+     * ```
+     */
+    struct [[eosio::table]] pipeline_stats_row {
+        std::vector<stage_metric> stages;
+        uint64_t num_blocks;
+        uint64_t avg_rows_per_block;
+    };
+    typedef eosio::singleton<"pipestats"_n, pipeline_stats_row> pipeline_stats_table;
+
+    /**
+     * ## TABLE `forkprune`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} pruned_height` - losing forks less than or equal to this height have been pruned
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "pruned_height": 840003
+     * }
+     * ```
+     */
+    struct [[eosio::table]] fork_prune_row {
+        uint64_t pruned_height;
+    };
+    typedef eosio::singleton<"forkprune"_n, fork_prune_row> fork_prune_table;
+
+    /**
+     * ## TABLE `gcconfig`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} retained_reward_log_blocks` - number of blocks of rwddist reward logs to retain, 0 disables it
+     * - `{uint64_t} retained_distribution_blocks` - number of blocks of gasfund distributions to retain, 0 disables it
+     * - `{uint16_t} max_actions` - maximum number of cleanup inline actions sent by each `processblock` call
+     * - `{uint64_t} max_rows` - maximum cost units spent on cleanup by each `processblock` call @see `workcost`
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "retained_reward_log_blocks": 4320,
+     *   "retained_distribution_blocks": 4320,
+     *   "max_actions": 5,
+     *   "max_rows": 500
+     * }
+     * ```
+     */
+    struct [[eosio::table]] gc_config_row {
+        uint64_t retained_reward_log_blocks;
+        uint64_t retained_distribution_blocks;
+        uint16_t max_actions;
+        uint64_t max_rows;
+    };
+    typedef eosio::singleton<"gcconfig"_n, gc_config_row> gc_config_table;
+
+    /**
+     * ## TABLE `gcstate`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} spent_utxo_height` - spent utxos and spent logs less than or equal to this height have been deleted
+     * - `{uint64_t} block_data_height` - block data less than or equal to this height has been deleted
+     * - `{uint64_t} reward_log_height` - rwddist reward logs less than or equal to this height have been deleted
+     * - `{uint64_t} distribution_height` - gasfund distributions starting at or below this height have been deleted
+     * - `{uint64_t} backlog` - number of heights that are beyond their retention window but not yet collected
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "spent_utxo_height": 839000,
+     *   "block_data_height": 839900,
+     *   "reward_log_height": 835680,
+     *   "distribution_height": 835200,
+     *   "backlog": 120
+     * }
+     * ```
+     */
+    struct [[eosio::table]] gc_state_row {
+        uint64_t spent_utxo_height;
+        uint64_t block_data_height;
+        uint64_t reward_log_height;
+        uint64_t distribution_height;
+        uint64_t backlog;
+    };
+    typedef eosio::singleton<"gcstate"_n, gc_state_row> gc_state_table;
+
+    /**
+     * ## TABLE `parseshards`
+     *
+     * ### scope `bucket_id`
+     * ### params
+     *
+     * - `{uint64_t} id` - shard index
+     * - `{uint64_t} start_transaction` - index of the first transaction of the shard in the block
+     * - `{parsing_progress_row} progress` - parsing progress of the shard @see `parsing_progress_row`
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 1,
+     *   "start_transaction": 500,
+     *   "progress": {
+     *       "bucket_id": 11,
+     *       "num_utxos": 1024,
+     *       "num_transactions": 500,
+     *       "parsed_transactions": 320,
+     *       "parsed_position": 281736,
+     *       "parsed_vin": 0,
+     *       "parsed_vout": 0,
+     *       "parser": "bob",
+     *       "parse_expiration_time": "2024-08-08T02:44:43"
+     *   }
+     * }
+     * ```
+     */
+    struct [[eosio::table]] parse_shard_row {
+        uint64_t id;
+        uint64_t start_transaction;
+        parsing_progress_row progress;
+        uint64_t primary_key() const { return id; }
+    };
+    typedef eosio::multi_index<"parseshards"_n, parse_shard_row> parse_shard_table;
+
+    /**
+     * ## TABLE `parsesplit`
+     *
+     * ### scope `bucket_id`
+     * ### params
+     *
+     * - `{uint64_t} num_transactions` - number of transactions of the block
+     * - `{uint32_t} num_txs_per_shard` - shard size the block is being split with
+     * - `{uint64_t} split_transactions` - number of transactions whose shard has been recorded in `parseshards`
+     * - `{uint64_t} split_position` - position of the next transaction to split, relative to the end of the block header
+     *
+     * > Only exists while the start positions of the shards of a block are being recorded.
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "num_transactions": 3050,
+     *   "num_txs_per_shard": 500,
+     *   "split_transactions": 1200,
+     *   "split_position": 693517
+     * }
+     * ```
+     */
+    struct [[eosio::table]] parse_split_row {
+        uint64_t num_transactions;
+        uint32_t num_txs_per_shard;
+        uint64_t split_transactions;
+        uint64_t split_position;
+    };
+    typedef eosio::singleton<"parsesplit"_n, parse_split_row> parse_split_table;
+
+    /**
+     * ## TABLE `parsingblks`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} height` - block height, equal to `parsing_height` of `chainstate`
+     * - `{checksum256} hash` - block hash
+     * - `{parsing_progress_row} progress` - parsing progress @see `parsing_progress_row`
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "height": 840009,
+     *   "hash": "00000000000000000000c6075e66b667adcdb8935e6d9a877f5cf140c806ae87",
+     *   "progress": {
+     *       "bucket_id": 11,
+     *       "num_utxos": 0,
+     *       "num_transactions": 0,
+     *       "parsed_transactions": 0,
+     *       "parsed_position": 0,
+     *       "parsed_vin": 0,
+     *       "parsed_vout": 0,
+     *       "parser": "alice",
+     *       "parse_expiration_time": "2024-08-08T02:44:43"
+     *   }
+     * }
+     * ```
+     */
+    struct [[eosio::table]] parsing_block_row {
+        uint64_t height;
+        checksum256 hash;
+        parsing_progress_row progress;
+        uint64_t primary_key() const { return progress.bucket_id; }
+        checksum256 by_hash() const { return hash; }
+    };
+    typedef eosio::multi_index<
+        "parsingblks"_n, parsing_block_row,
+        eosio::indexed_by<"byhash"_n, const_mem_fun<parsing_block_row, checksum256, &parsing_block_row::by_hash>>>
+        parsing_block_table;
+
+    /**
+     * ## TABLE `specparsing`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - primary key
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{parsing_progress_row} progress` - speculative parsing progress @see `parsing_progress_row`
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 1,
+     *   "height": 840009,
+     *   "hash": "00000000000000000000c6075e66b667adcdb8935e6d9a877f5cf140c806ae87",
+     *   "progress": {
+     *       "bucket_id": 11,
+     *       "num_utxos": 2048,
+     *       "num_transactions": 3050,
+     *       "parsed_transactions": 420,
+     *       "parsed_position": 298312,
+     *       "parsed_vin": 0,
+     *       "parsed_vout": 0,
+     *       "parser": "alice",
+     *       "parse_expiration_time": "2024-08-08T02:44:43"
+     *   }
+     * }
+     * ```
+     */
+    struct [[eosio::table]] spec_parsing_row {
+        uint64_t id;
+        uint64_t height;
+        checksum256 hash;
+        parsing_progress_row progress;
+        uint64_t primary_key() const { return id; }
+        uint64_t by_height() const { return height; }
+        checksum256 by_block_id() const { return xsat::utils::compute_block_id(height, hash); }
+    };
+    typedef eosio::multi_index<
+        "specparsing"_n, spec_parsing_row,
+        eosio::indexed_by<"byheight"_n, const_mem_fun<spec_parsing_row, uint64_t, &spec_parsing_row::by_height>>,
+        eosio::indexed_by<"byblockid"_n, const_mem_fun<spec_parsing_row, checksum256, &spec_parsing_row::by_block_id>>>
+        spec_parsing_table;
+
+    /**
+     * ## TABLE `blocks`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block
+     * - `{uint32_t} version` - block version
+     * - `{checksum256} previous_block_hash` - hash in internal byte order of the previous block’s header
+     * - `{checksum256} merkle` - the merkle root is derived from the hashes of all transactions included in this block
+     * - `{uint32_t} timestamp` - the block time is a Unix epoch time
+     * - `{uint32_t} bits` - an encoded version of the target threshold this block’s header hash must be less than or equal to
+     * - `{uint32_t} nonce` - an arbitrary number miners change to modify the header hash in order to produce a hash less than or
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "height": 840011,
+     *   "hash": "00000000000000000002d12efb02bcf70580b2eebf4b775578844640512e30f3",
+     *   "cumulative_work": "0000000000000000000000000000000000000000753f3af9322a2a893cb6ece4",
+     *   "version": 747323392,
+     *   "previous_block_hash": "00000000000000000000da20f7d8e9e6412d4f1d8b62d88264cddbdd48256ba0",
+     *   "merkle": "476eac37dd22a59952c5812f715a3e39b68663e40d80d756ba44d7d59e7d6a0a",
+     *   "timestamp": 1713576761,
+     *   "bits": 386089497,
+     *   "nonce": 1492849681
+     *  }
+     * ```
+     */
+    struct [[eosio::table]] block_row {
+        uint64_t height;
+        checksum256 hash;
+        checksum256 cumulative_work;
+        uint32_t version;
+        checksum256 previous_block_hash;
+        checksum256 merkle;
+        uint32_t timestamp;
+        uint32_t bits;
+        uint32_t nonce;
+        uint64_t primary_key() const { return height; }
+        checksum256 by_hash() const { return hash; }
+    };
+    typedef eosio::multi_index<
+        "blocks"_n, block_row,
+        eosio::indexed_by<"byhash"_n, const_mem_fun<block_row, checksum256, &block_row::by_hash>>>
+        block_table;
+
+    /**
+     * ## TABLE `headers`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} id` - chunk id, `height / 16`, small chunks keep the row rewritten by each archived header short
+     * - `{uint64_t} start_height` - height of the first header in the chunk
+     * - `{vector<uint8_t>} headers` - consecutive irreversible headers of 112 bytes each, serialized as `hash ||
+     * cumulative_work || version || merkle || timestamp || bits || nonce`. The previous block hash is the hash of the
+     * previous header
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "id": 52500,
+     *   "start_height": 840000,
+     *   "headers": "a583da1c3ff29b68724fff737822f8ce4827033a2883200300000000000000000000000000000000000000000000000000000000753e2b3d..."
+     * }
+     * ```
+     */
+    struct [[eosio::table]] header_chunk_row {
+        uint64_t id;
+        uint64_t start_height;
+        std::vector<uint8_t> headers;
+        uint64_t primary_key() const { return id; }
+    };
+    typedef eosio::multi_index<"headers"_n, header_chunk_row> header_chunk_table;
+
+    /**
+     * ## TABLE `block.extra`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} height` - block height
+     * - `{uint64_t} bucket_id` - the associated bucket number is used to obtain block data
+     * - `{binary_extension<checksum256>} utxo_commitment` - `utxoset` commitment after the block was migrated, zero
+     * until the backfill has completed
+     * - `{binary_extension<uint64_t>} num_utxos` - number of utxos after the block was migrated
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "height": 840001,
+     *   "bucket_id": 1,
+     *   "utxo_commitment": "7bd0fc1b52bcf8e1c0b1b8a7d2c2a1d3fce0a7a6a1e39f18ae1f1bb0ec7e0e3c",
+     *   "num_utxos": 185169894
+     * }
+     * ```
+     */
+    struct [[eosio::table]] block_extra_row {
+        uint64_t height;
+        uint64_t bucket_id;
+        binary_extension<checksum256> utxo_commitment;
+        binary_extension<uint64_t> num_utxos;
+        uint64_t primary_key() const { return height; }
+    };
+    typedef eosio::multi_index<"block.extra"_n, block_extra_row> block_extra_table;
+
+    /**
+     * ## TABLE `consensusblk`
+     *
+     * ### scope `get_self()`
+     * ### params
+     *
+     * - `{uint64_t} bucket_id` - the associated bucket number is used to obtain block data
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block
+     * - `{uint32_t} version` - block version
+     * - `{checksum256} previous_block_hash` - hash in internal byte order of the previous block’s header
+     * - `{checksum256} merkle` - the merkle root is derived from the hashes of all transactions included in this block
+     * - `{uint32_t} timestamp` - the block time is a Unix epoch time
+     * - `{uint32_t} bits` - an encoded version of the target threshold this block’s header hash must be less than or equal to
+     * - `{uint32_t} nonce` - an arbitrary number miners change to modify the header hash in order to produce a hash less than or
+     * - `{name} miner` - block miner account
+     * - `{name} synchronizer` - block synchronizer account
+     * - `{name} parser` - the last parser of the parsing block
+     * - `{uint64_t} num_utxos` - the total number of vin and vout of the block
+     * - `{bool} parse` - is it an parsed block
+     * - `{bool} irreversible` - is it an irreversible block
+     * - `{time_point_sec} created_at` - created at time
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "bucket_id": 5,
+     *   "height": 840003,
+     *   "hash": "00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119",
+     *   "cumulative_work": "0000000000000000000000000000000000000000753cc66782a80f6f099fe68c",
+     *   "version": 704643072,
+     *   "previous_block_hash": "00000000000000000002c0cc73626b56fb3ee1ce605b0ce125cc4fb58775a0a9",
+     *   "merkle": "2daee999cac85a7663bbc3a0e24bd7c86e009c005e7d801ef104d134b420179b",
+     *   "timestamp": 1713572633,
+     *   "bits": 386089497,
+     *   "nonce": 213198539,
+     *   "miner": "",
+     *   "synchronizer": "alice",
+     *   "parser": "alice",
+     *   "num_utxos": 16278,
+     *   "parse": 1,
+     *   "irreversible": 1,
+     *   "created_at": "2024-08-13T00:00:00"
+     * }
+     * ```
+     */
+    struct [[eosio::table]] consensus_block_row {
+        uint64_t bucket_id;
+        uint64_t height;
+        checksum256 hash;
+        checksum256 cumulative_work;
+        uint32_t version;
+        checksum256 previous_block_hash;
+        checksum256 merkle;
+        uint32_t timestamp;
+        uint32_t bits;
+        uint32_t nonce;
+        name miner;
+        name synchronizer;
+        name parser;
+        uint64_t num_utxos;
+        bool irreversible;
+        bool parse;
+        time_point_sec created_at;
+        uint64_t primary_key() const { return bucket_id; }
+        uint64_t by_height() const { return height; }
+        uint64_t by_synchronizer() const { return synchronizer.value; }
+        uint128_t by_parse_height() const { return compute_parse_height(parse, height); }
+        checksum256 by_block_id() const { return xsat::utils::compute_block_id(height, hash); }
+    };
+    typedef eosio::multi_index<
+        "consensusblk"_n, consensus_block_row,
+        eosio::indexed_by<"byheight"_n, const_mem_fun<consensus_block_row, uint64_t, &consensus_block_row::by_height>>,
+        eosio::indexed_by<"bysyncer"_n,
+                          const_mem_fun<consensus_block_row, uint64_t, &consensus_block_row::by_synchronizer>>,
+        eosio::indexed_by<"parseheight"_n,
+                          const_mem_fun<consensus_block_row, uint128_t, &consensus_block_row::by_parse_height>>,
+        eosio::indexed_by<"byblockid"_n,
+                          const_mem_fun<consensus_block_row, checksum256, &consensus_block_row::by_block_id>>>
+        consensus_block_table;
+
+    /**
+     * ## STRUCT `process_block_result`
+     *
+     * ### params
+     *
+     * - `{string} status` - current parsing status (waiting, migrating, deleting_data, distributing_rewards, parsing, parsing_completed)
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} block_hash` - block hash
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "status": "parsing",
+     *   "height": 840000,
+     *   "block_hash": "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5"
+     * }
+     * ```
+     */
+    struct process_block_result {
+        string status;
+        uint64_t height;
+        checksum256 block_hash;
+    };
+
+    /**
+     * ## STRUCT `outpoint`
+     *
+     * ### params
+     *
+     * - `{checksum256} txid` - transaction id
+     * - `{uint32_t} index` - vout index
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "txid": "2bb85f4b004be6da54f766c17c1e855187327112c231ef2ff35ebad0ea67c69e",
+     *   "index": 0
+     * }
+     * ```
+     */
+    struct outpoint {
+        checksum256 txid;
+        uint32_t index;
+    };
+
+    /**
+     * ## STRUCT `utxo_page`
+     *
+     * ### params
+     *
+     * - `{std::vector<utxo_row>} utxos` - utxos of the page
+     * - `{uint64_t} next_cursor` - cursor of the next page, 0 if there are no more utxos
+     * - `{bool} cold_omitted` - true if some utxos of the script have been moved to `coldutxos`, those are not listed
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "utxos": [{
+     *     "id": 2,
+     *     "txid": "2bb85f4b004be6da54f766c17c1e855187327112c231ef2ff35ebad0ea67c69e",
+     *     "index": 0,
+     *     "scriptpubkey": "51203b8b3ab1453eb47e2d4903b963776680e30863df3625d3e74292338ae7928da1",
+     *     "value": 1797928002
+     *   }],
+     *   "next_cursor": 0,
+     *   "cold_omitted": false
+     * }
+     * ```
+     */
+    struct utxo_page {
+        std::vector<utxo_row> utxos;
+        uint64_t next_cursor;
+        bool cold_omitted;
+    };
+
+    /**
+     * ## STRUCT `tx_proof`
+     *
+     * ### params
+     *
+     * - `{checksum256} block_hash` - hash of the block containing the transaction
+     * - `{checksum256} merkle` - merkle root of the block header
+     * - `{uint32_t} index` - position of the transaction in the block
+     * - `{std::vector<uint8_t>} raw_transaction` - serialized transaction, including witness data
+     * - `{std::vector<checksum256>} branch` - merkle siblings from the transaction up to the root, in the same byte
+     * order as txid
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "block_hash": "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5",
+     *   "merkle": "031b417c3a1828ddf3d6527fc210daafcc9218e81f98257f88d4d43bd7a5894f",
+     *   "index": 1,
+     *   "raw_transaction": "02000000000101...",
+     *   "branch": ["a0db149ace545beabbd87a8d6b20ffd6aa3b5a50e58add49a3d435f898c272cf", ...]
+     * }
+     * ```
+     */
+    struct tx_proof {
+        checksum256 block_hash;
+        checksum256 merkle;
+        uint32_t index;
+        std::vector<uint8_t> raw_transaction;
+        std::vector<checksum256> branch;
+    };
+
+    /**
+     * ## STRUCT `endorsement_quorum`
+     *
+     * ### params
+     *
+     * - `{uint64_t} validator_set_id` - the `blkendt.xsat` validator set of the vote bitmaps, 0 if the endorsement keeps validator lists
+     * - `{uint16_t} num_validators` - number of requested validators
+     * - `{uint16_t} num_providers` - number of validators that have endorsed
+     * - `{uint64_t} total_staking` - staking sum of the requested validators
+     * - `{uint64_t} provided_staking` - staking sum of the validators that have endorsed
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "validator_set_id": 12,
+     *   "num_validators": 4,
+     *   "num_providers": 3,
+     *   "total_staking": "40000000000",
+     *   "provided_staking": "30000000000"
+     * }
+     * ```
+     */
+    struct endorsement_quorum {
+        uint64_t validator_set_id;
+        uint16_t num_validators;
+        uint16_t num_providers;
+        uint64_t total_staking;
+        uint64_t provided_staking;
+    };
+
+    /**
+     * ## STRUCT `quorum_proof`
+     *
+     * ### params
+     *
+     * - `{endorsement_quorum} btc` - quorum of the BTC endorsement
+     * - `{optional<endorsement_quorum>} xsat` - quorum of the XSAT endorsement, set once XSAT consensus is active
+     *
+     * ### example
+     *
+     * ```json
+     * {
+     *   "btc": {"validator_set_id": 12, "num_validators": 4, "num_providers": 3, "total_staking": "40000000000", "provided_staking": "30000000000"},
+     *   "xsat": null
+     * }
+     * ```
+     */
+    struct quorum_proof {
+        endorsement_quorum btc;
+        optional<endorsement_quorum> xsat;
+    };
+
+    /**
+     * ## ACTION `init`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Initialize block information to start parsing.
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{checksum256} cumulative_work` - the cumulative workload of the block
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat init '[839999,
+     * "0000000000000000000172014ba58d66455762add0512355ad651207918494ab",
+     * "0000000000000000000000000000000000000000753b8c1eaae701e1f0146360"]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void init(const uint64_t height, const checksum256 &hash, const checksum256 &cumulative_work);
+
+    /**
+     * ## ACTION `config`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Setting parameters.
+     *
+     * ### params
+     *
+     * - `{uint16_t} parse_timeout_seconds` - parsing timeout duration
+     * - `{uint16_t} num_validators_per_distribution` - number of endorsing users each time rewards are distributed
+     * - `{uint16_t} retained_spent_utxo_blocks` - number of blocks to retain utxo
+     * - `{uint16_t} num_retain_data_blocks` - number of blocks to retain data
+     * - `{uint8_t} num_merkle_layer` - verify the number of merkle levels (log(num_txs_per_verification))
+     * - `{uint16_t} num_miner_priority_blocks` - miners who produce blocks give priority to verifying the number of blocks
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat config '[600, 100, 5000, 100, 11, 10]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void config(const uint16_t parse_timeout_seconds, const uint16_t num_validators_per_distribution,
+                const uint16_t retained_spent_utxo_blocks, const uint16_t num_retain_data_blocks,
+                const uint8_t num_merkle_layer, const uint16_t num_miner_priority_blocks);
+
+    /**
+     * ## ACTION `setworkcost`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Set the cost model used to budget the work of each `processblock` call.
+     *
+     * ### params
+     *
+     * - `{uint64_t} budget` - maximum cost units consumed by each `processblock` call, 0 means the `process_rows`
+     * passed by the caller is used as is
+     * - `{uint32_t} pending_emplace` - cost of parsing a vin/vout into `pendingutxos`
+     * - `{uint32_t} remove_utxo` - cost of removing a spent utxo from `utxos`
+     * - `{uint32_t} save_utxo` - cost of saving a new utxo to `utxos`
+     * - `{uint32_t} save_spent_utxo` - cost of recording a spent utxo in `spentlog`
+     * - `{uint32_t} pending_erase` - cost of erasing a `pendingutxos` row (also applied to other row deletions)
+     * - `{uint32_t} deserialize_kbytes` - cost of deserializing 1024 bytes of transaction data
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat setworkcost '[20000, 10, 12, 10, 6, 6, 4]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void setworkcost(const uint64_t budget, const uint32_t pending_emplace, const uint32_t remove_utxo,
+                     const uint32_t save_utxo, const uint32_t save_spent_utxo, const uint32_t pending_erase,
+                     const uint32_t deserialize_kbytes);
+
+    /**
+     * ## ACTION `setshardsize`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Set the number of transactions per parse shard.
+     *
+     * ### params
+     *
+     * - `{uint32_t} num_txs_per_shard` - blocks with more transactions are split into shards of this size that can be
+     * parsed by different synchronizers, 0 disables sharding
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat setshardsize '[500]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void setshardsize(const uint32_t num_txs_per_shard);
 
     /**
-     * ## STRUCT `process_block_result`
+     * ## ACTION `setgcconfig`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Enable the garbage collection that `processblock` runs with its leftover budget. Spent utxos and block data
+     * follow `retained_spent_utxo_blocks` and `num_retain_data_blocks` of `config`.
      *
      * ### params
      *
-     * - `{string} status` - current parsing status (waiting, migrating, deleting_data, distributing_rewards, parsing, parsing_completed)
-     * - `{uint64_t} height` - block height
-     * - `{checksum256} block_hash` - block hash
+     * - `{uint64_t} retained_reward_log_blocks` - number of blocks of rwddist reward logs to retain, 0 disables it
+     * - `{uint64_t} retained_distribution_blocks` - number of blocks of gasfund distributions to retain, 0 disables it
+     * - `{uint16_t} max_actions` - maximum number of cleanup inline actions sent by each `processblock` call
+     * - `{uint64_t} max_rows` - maximum cost units spent on cleanup by each `processblock` call, also when the call
+     * itself is unbounded
      *
      * ### example
      *
-     * ```json
-     * {
-     *   "status": "parsing",
-     *   "height": 840000,
-     *   "block_hash": "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5"
-     * }
+     * ```bash
+     * $ cleos push action utxomng.xsat setgcconfig '[4320, 4320, 5, 500]' -p utxomng.xsat
      * ```
      */
-    struct process_block_result {
-        string status;
-        uint64_t height;
-        checksum256 block_hash;
-    };
+    [[eosio::action]]
+    void setgcconfig(const uint64_t retained_reward_log_blocks, const uint64_t retained_distribution_blocks,
+                     const uint16_t max_actions, const uint64_t max_rows);
 
     /**
-     * ## ACTION `init`
+     * ## ACTION `setcoldtier`
      *
      * - **authority**: `get_self()`
      *
-     * > Initialize block information to start parsing.
+     * > Set how many recent utxos stay in `utxos`. `processblock` moves older utxos into the packed `coldutxos` rows
+     * with its leftover budget, and a cold utxo is only expanded when it is spent.
      *
      * ### params
      *
-     * - `{uint64_t} height` - block height
-     * - `{checksum256} hash` - block hash
-     * - `{checksum256} cumulative_work` - the cumulative workload of the block
+     * - `{uint64_t} retained_hot_utxos` - number of most recently created utxos kept in `utxos`, 0 stops moving utxos
+     * - `{uint32_t} max_frozen_utxos` - maximum number of utxos moved by each `processblock` call, must be greater than 0
      *
      * ### example
      *
      * ```bash
-     * $ cleos push action utxomng.xsat init '[839999,
-     * "0000000000000000000172014ba58d66455762add0512355ad651207918494ab",
-     * "0000000000000000000000000000000000000000753b8c1eaae701e1f0146360"]' -p utxomng.xsat
+     * $ cleos push action utxomng.xsat setcoldtier '[20000000, 500]' -p utxomng.xsat
      * ```
      */
     [[eosio::action]]
-    void init(const uint64_t height, const checksum256 &hash, const checksum256 &cumulative_work);
+    void setcoldtier(const uint64_t retained_hot_utxos, const uint32_t max_frozen_utxos);
 
     /**
-     * ## ACTION `config`
+     * ## ACTION `initbackfill`
      *
      * - **authority**: `get_self()`
      *
-     * > Setting parameters.
-     *
-     * ### params
-     *
-     * - `{uint16_t} parse_timeout_seconds` - parsing timeout duration
-     * - `{uint16_t} num_validators_per_distribution` - number of endorsing users each time rewards are distributed
-     * - `{uint16_t} retained_spent_utxo_blocks` - number of blocks to retain utxo
-     * - `{uint16_t} num_retain_data_blocks` - number of blocks to retain data
-     * - `{uint8_t} num_merkle_layer` - verify the number of merkle levels (log(num_txs_per_verification))
-     * - `{uint16_t} num_miner_priority_blocks` - miners who produce blocks give priority to verifying the number of blocks
+     * > Start indexing `balances` and `utxoset`. Utxos saved from now on are indexed when they are saved, and `processblock` folds
+     * the existing utxos into the index with its leftover budget, @see `backfill`.
      *
      * ### example
      *
      * ```bash
-     * $ cleos push action utxomng.xsat config '[600, 100, 5000, 100, 11, 10]' -p utxomng.xsat
+     * $ cleos push action utxomng.xsat initbackfill '[]' -p utxomng.xsat
      * ```
      */
     [[eosio::action]]
-    void config(const uint16_t parse_timeout_seconds, const uint16_t num_validators_per_distribution,
-                const uint16_t retained_spent_utxo_blocks, const uint16_t num_retain_data_blocks,
-                const uint8_t num_merkle_layer, const uint16_t num_miner_priority_blocks);
+    void initbackfill();
 
     /**
      * ## ACTION `addutxo`
@@ -609,6 +1569,30 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     void addutxo(const uint64_t id, const checksum256 &txid, const uint32_t index, const vector<uint8_t> &scriptpubkey,
                  const uint64_t value);
 
+    /**
+     * ## ACTION `importutxos`
+     *
+     * - **authority**: `get_self()`
+     *
+     * > Bulk import packed utxo data, each entry is serialized as `txid (32 bytes) || index (uint32 LE) || value
+     * (uint64 LE) || varint script length || scriptpubkey`.
+     *
+     * ### params
+     *
+     * - `{uint64_t} start_id` - primary id of the first utxo, the following utxos use consecutive ids
+     * - `{vector<uint8_t>} data` - packed utxos
+     * - `{checksum256} batch_commitment` - expected multiset hash of the batch @see `utxoset`
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat importutxos '[1, "c323eae524ce3b49f0868396eb9a61bea0e5fb3dc2e52cb46e04c2dba28a3c0d010000004f01f5250000000016001435f6de260c9f3bdee47524c473a6016c0c055cb9",
+     * "d55f5bfb06353c242f2bf2d4c7ff9ea9cc0973daa7fee70e171845bec74a1817"]' -p utxomng.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void importutxos(const uint64_t start_id, const vector<uint8_t> &data, const checksum256 &batch_commitment);
+
     /**
      * ## ACTION `delutxo`
      *
@@ -684,7 +1668,7 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
      *
      * - **authority**: `get_self()`
      *
-     * > Delete spent utxo.
+     * > Delete spent utxo. Legacy `spentutxos` rows are deleted first, then expired `spentlog` scopes are reclaimed.
      *
      * ### params
      *
@@ -726,13 +1710,17 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
      *
      * - **authority**: `synchronizer`
      *
-     * > Parse utxo
+     * > Migrate the irreversible block first and then parse utxo. Once the current block has been parsed by
+     * `parseblock`, any synchronizer can drive the remaining migration. The rest of the budget is spent on pruning
+     * consensus blocks of losing forks, @see `forkprune`, then on deleting data beyond its retention window,
+     * @see `gcconfig`, then on indexing existing utxos, @see `backfill`, and finally on moving dormant utxos,
+     * @see `coldtier`.
      *
      * ### params
      *
      * - `{name} synchronizer` - synchronizer account
-     * - `{uint64_t} process_rows` - number of vins and vouts to be parsed
-     * - `{uint64_t} none` - unique value for each call to prevent duplicate transactions 
+     * - `{uint64_t} process_rows` - cost units to spend on this call @see `workcost`, 0 means the configured budget
+     * - `{uint64_t} nonce` - unique value for each call to prevent duplicate transactions 
      *
      * ### example
      *
@@ -743,6 +1731,56 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     [[eosio::action]]
     process_block_result processblock(const name &synchronizer, uint64_t process_rows, const uint64_t nonce);
 
+    /**
+     * ## ACTION `parseblock`
+     *
+     * - **authority**: `synchronizer`
+     *
+     * > Parse utxo of the current parsing block only, so that it can proceed while the irreversible block is being
+     * migrated by `processblock`.
+     *
+     * ### params
+     *
+     * - `{name} synchronizer` - synchronizer account
+     * - `{uint64_t} process_rows` - cost units to spend on this call @see `workcost`, 0 means the configured budget
+     * - `{uint64_t} nonce` - unique value for each call to prevent duplicate transactions
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat parseblock '["bob", 1000, 1]' -p bob
+     * ```
+     */
+    [[eosio::action]]
+    process_block_result parseblock(const name &synchronizer, uint64_t process_rows, const uint64_t nonce);
+
+    /**
+     * ## ACTION `specparse`
+     *
+     * - **authority**: `synchronizer`
+     *
+     * > Speculatively parse utxo of a block that has passed verification but has not reached consensus yet. The
+     * progress is taken over by `processblock` if the block reaches consensus, otherwise its pending utxos are deleted
+     * together with the other forks when the height becomes irreversible.
+     *
+     * ### params
+     *
+     * - `{name} synchronizer` - synchronizer account
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{uint64_t} process_rows` - cost units to spend on this call @see `workcost`, 0 means the configured budget
+     * - `{uint64_t} nonce` - unique value for each call to prevent duplicate transactions
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat specparse '["alice", 840009, "00000000000000000000c6075e66b667adcdb8935e6d9a877f5cf140c806ae87", 1000, 1]' -p alice
+     * ```
+     */
+    [[eosio::action]]
+    process_block_result specparse(const name &synchronizer, const uint64_t height, const checksum256 &hash,
+                                   uint64_t process_rows, const uint64_t nonce);
+
     /**
      * ## ACTION `consensus`
      *
@@ -764,6 +1802,158 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     [[eosio::action]]
     void consensus(const uint64_t height, const checksum256 &hash);
 
+    /**
+     * ## ACTION `qconsensus`
+     *
+     * - **authority**: `blkendt.xsat`
+     *
+     * > Reach consensus logic with the quorum already evaluated by `blkendt.xsat`, the endorsement records are not read again
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{quorum_proof} proof` - the quorum of the BTC and XSAT endorsements
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat qconsensus '[840000, "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5", {"btc": {"validator_set_id": 12, "num_validators": 4, "num_providers": 3, "total_staking": "40000000000", "provided_staking": "30000000000"}, "xsat": null}]' -p blkendt.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void qconsensus(const uint64_t height, const checksum256 &hash, const quorum_proof &proof);
+
+    /**
+     * ## ACTION `recordstage`
+     *
+     * - **authority**: `blksync.xsat` or `blkendt.xsat`
+     *
+     * > Record that a block reached a pipeline stage, @see `timelines` and `pipestats`.
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} hash` - block hash
+     * - `{pipeline_stage} stage` - the stage that was reached
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat recordstage '[840000, "0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5", 0]' -p blksync.xsat
+     * ```
+     */
+    [[eosio::action]]
+    void recordstage(const uint64_t height, const checksum256 &hash, const pipeline_stage stage);
+
+    /**
+     * ## ACTION `utxosbyscrpt`
+     *
+     * - **authority**: anyone, read-only
+     *
+     * > Page through the utxos locked by a scriptpubkey. Utxos moved to `coldutxos` are not indexed by script, they are
+     * only counted by `getbalance` and found by `getoutpoints`, and `cold_omitted` is set if the script has any.
+     *
+     * ### params
+     *
+     * - `{std::vector<uint8_t>} scriptpubkey` - script public key
+     * - `{uint64_t} cursor` - `next_cursor` of the previous page, 0 for the first page
+     * - `{uint16_t} limit` - maximum number of utxos to return, at most `MAX_UTXO_QUERY_ROWS`
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat utxosbyscrpt '["51203b8b3ab1453eb47e2d4903b963776680e30863df3625d3e74292338ae7928da1", 0, 100]' -p alice --read-only
+     * ```
+     */
+    [[eosio::action, eosio::read_only]]
+    utxo_page utxosbyscrpt(const std::vector<uint8_t> &scriptpubkey, const uint64_t cursor, const uint16_t limit);
+
+    /**
+     * ## ACTION `utxosbyaddr`
+     *
+     * - **authority**: anyone, read-only
+     *
+     * > Page through the utxos of a bitcoin address, @see `utxosbyscrpt`.
+     *
+     * ### params
+     *
+     * - `{string} address` - bitcoin address
+     * - `{uint64_t} cursor` - `next_cursor` of the previous page, 0 for the first page
+     * - `{uint16_t} limit` - maximum number of utxos to return, at most `MAX_UTXO_QUERY_ROWS`
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat utxosbyaddr '["bc1p8w9n4v298668ut2fqwukxamxsr3ssc7lxcja8e6zjgec4euj3ksswckxz6", 0, 100]' -p alice --read-only
+     * ```
+     */
+    [[eosio::action, eosio::read_only]]
+    utxo_page utxosbyaddr(const string &address, const uint64_t cursor, const uint16_t limit);
+
+    /**
+     * ## ACTION `getoutpoints`
+     *
+     * - **authority**: anyone, read-only
+     *
+     * > Look up a batch of outpoints in `utxos` and `coldutxos`, spent or unknown outpoints are omitted.
+     *
+     * ### params
+     *
+     * - `{std::vector<outpoint>} outpoints` - outpoints to look up, at most `MAX_UTXO_QUERY_ROWS`
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat getoutpoints '[[{"txid": "2bb85f4b004be6da54f766c17c1e855187327112c231ef2ff35ebad0ea67c69e", "index": 0}]]' -p alice --read-only
+     * ```
+     */
+    [[eosio::action, eosio::read_only]]
+    std::vector<utxo_row> getoutpoints(const std::vector<outpoint> &outpoints);
+
+    /**
+     * ## ACTION `getbalance`
+     *
+     * - **authority**: anyone, read-only
+     *
+     * > Get the total value and number of utxos of a bitcoin address, including utxos in `coldutxos`. Fails until
+     * every existing utxo has been indexed, @see `backfill`.
+     *
+     * ### params
+     *
+     * - `{string} address` - bitcoin address
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat getbalance '["bc1p8w9n4v298668ut2fqwukxamxsr3ssc7lxcja8e6zjgec4euj3ksswckxz6"]' -p alice --read-only
+     * ```
+     */
+    [[eosio::action, eosio::read_only]]
+    balance_row getbalance(const string &address);
+
+    /**
+     * ## ACTION `gettxproof`
+     *
+     * - **authority**: anyone, read-only
+     *
+     * > Get a transaction and its merkle branch to the header merkle root, from the block data that is still retained
+     * (the last `num_retain_data_blocks` irreversible blocks and blocks that reached consensus).
+     *
+     * ### params
+     *
+     * - `{uint64_t} height` - block height
+     * - `{checksum256} txid` - transaction id
+     *
+     * ### example
+     *
+     * ```bash
+     * $ cleos push action utxomng.xsat gettxproof '[840000, "a0db149ace545beabbd87a8d6b20ffd6aa3b5a50e58add49a3d435f898c272cf"]' -p alice --read-only
+     * ```
+     */
+    [[eosio::action, eosio::read_only]]
+    tx_proof gettxproof(const uint64_t height, const checksum256 &txid);
+
 #ifdef DEBUG
     [[eosio::action]]
     void cleartable(const name table_name, const optional<uint64_t> scope, const optional<uint64_t> max_rows);
@@ -805,6 +1995,8 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     }
 
     using consensus_action = eosio::action_wrapper<"consensus"_n, &utxo_manage::consensus>;
+    using qconsensus_action = eosio::action_wrapper<"qconsensus"_n, &utxo_manage::qconsensus>;
+    using recordstage_action = eosio::action_wrapper<"recordstage"_n, &utxo_manage::recordstage>;
     using lostutxolog_action = eosio::action_wrapper<"lostutxolog"_n, &utxo_manage::lostutxolog>;
 
     static checksum256 compute_type_id_for_block(const uint64_t height, const checksum256 &hash, const name &type) {
@@ -851,9 +2043,51 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
         if (consensus_block_itr != consensus_block_idx.end())
             return true;
 
+        return get_irreversible_block(height).has_value();
+    }
+
+    static optional<block_row> read_header_record(const header_chunk_row &chunk, const uint64_t height) {
+        if (height < chunk.start_height) return std::nullopt;
+        auto offset = (height - chunk.start_height) * HEADER_RECORD_SIZE;
+        if (offset + HEADER_RECORD_SIZE > chunk.headers.size()) return std::nullopt;
+
+        eosio::datastream<const char *> ds((const char *)chunk.headers.data() + offset, HEADER_RECORD_SIZE);
+        block_row block = {.height = height};
+        ds >> block.hash >> block.cumulative_work >> block.version >> block.merkle >> block.timestamp >> block.bits
+            >> block.nonce;
+        return block;
+    }
+
+    static optional<block_row> get_irreversible_block(const uint64_t height) {
+        // Headers after the start height are only archived once the block is migrated
+        utxo_manage::chain_state_table _chain_state(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+        auto chain_state = _chain_state.get_or_default();
+        if (height > START_HEIGHT && height > std::max(chain_state.irreversible_height, chain_state.migrating_height)) {
+            return std::nullopt;
+        }
+
+        utxo_manage::header_chunk_table _header_chunk(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
+        auto header_chunk_itr = _header_chunk.find(height / HEADERS_PER_CHUNK);
+        if (header_chunk_itr != _header_chunk.end()) {
+            auto block = read_header_record(*header_chunk_itr, height);
+            if (block.has_value()) {
+                auto previous_block = height > header_chunk_itr->start_height
+                                          ? read_header_record(*header_chunk_itr, height - 1)
+                                          : get_irreversible_block(height - 1);
+                if (previous_block.has_value()) {
+                    block->previous_block_hash = previous_block->hash;
+                }
+                return block;
+            }
+        }
+
+        // Blocks before the header archive
         utxo_manage::block_table _block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
         auto block_itr = _block.find(height);
-        return block_itr != _block.end();
+        if (block_itr != _block.end()) {
+            return *block_itr;
+        }
+        return std::nullopt;
     }
 
     static optional<bitcoin::core::block> get_ancestor(const uint64_t height, const optional<checksum256> hash) {
@@ -871,16 +2105,14 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
                                             .bits = consensus_block_itr->bits};
             }
 
-            utxo_manage::block_table _block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-            auto block_idx = _block.get_index<"byhash"_n>();
-            auto block_itr = block_idx.find(*hash);
-            if (block_itr != block_idx.end()) {
+            auto block = get_irreversible_block(height);
+            if (block.has_value() && block->hash == *hash) {
                 return bitcoin::core::block{.height = height,
-                                            .hash = block_itr->hash,
-                                            .previous_block_hash = block_itr->previous_block_hash,
-                                            .cumulative_work = block_itr->cumulative_work,
-                                            .timestamp = block_itr->timestamp,
-                                            .bits = block_itr->bits};
+                                            .hash = block->hash,
+                                            .previous_block_hash = block->previous_block_hash,
+                                            .cumulative_work = block->cumulative_work,
+                                            .timestamp = block->timestamp,
+                                            .bits = block->bits};
             }
         } else {
             auto consensus_block_idx = _consensus_block.get_index<"byheight"_n>();
@@ -894,15 +2126,14 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
                                             .bits = consensus_block_itr->bits};
             }
 
-            utxo_manage::block_table _block(UTXO_MANAGE_CONTRACT, UTXO_MANAGE_CONTRACT.value);
-            auto block_itr = _block.find(height);
-            if (block_itr != _block.end()) {
+            auto block = get_irreversible_block(height);
+            if (block.has_value()) {
                 return bitcoin::core::block{.height = height,
-                                            .hash = block_itr->hash,
-                                            .previous_block_hash = block_itr->previous_block_hash,
-                                            .cumulative_work = block_itr->cumulative_work,
-                                            .timestamp = block_itr->timestamp,
-                                            .bits = block_itr->bits};
+                                            .hash = block->hash,
+                                            .previous_block_hash = block->previous_block_hash,
+                                            .cumulative_work = block->cumulative_work,
+                                            .timestamp = block->timestamp,
+                                            .bits = block->bits};
             }
         }
         return result;
@@ -912,21 +2143,129 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
     // table init
     config_table _config = config_table(_self, _self.value);
     chain_state_table _chain_state = chain_state_table(_self, _self.value);
+    chain_cursor_table _chain_cursor = chain_cursor_table(_self, _self.value);
     block_extra_table _block_extra = block_extra_table(_self, _self.value);
     utxo_table _utxo = utxo_table(_self, _self.value);
     pending_utxo_table _pending_utxo = pending_utxo_table(_self, _self.value);
     spent_utxo_table _spent_utxo = spent_utxo_table(_self, _self.value);
+    spent_state_table _spent_state = spent_state_table(_self, _self.value);
+    work_cost_table _work_cost = work_cost_table(_self, _self.value);
+    spec_parsing_table _spec_parsing = spec_parsing_table(_self, _self.value);
+    balance_table _balance = balance_table(_self, _self.value);
+    backfill_table _backfill = backfill_table(_self, _self.value);
+    utxo_set_table _utxo_set = utxo_set_table(_self, _self.value);
+    parsing_block_table _parsing_block = parsing_block_table(_self, _self.value);
+    header_chunk_table _header_chunk = header_chunk_table(_self, _self.value);
+    fork_prune_table _fork_prune = fork_prune_table(_self, _self.value);
+    gc_config_table _gc_config = gc_config_table(_self, _self.value);
+    gc_state_table _gc_state = gc_state_table(_self, _self.value);
+    cold_tier_table _cold_tier = cold_tier_table(_self, _self.value);
+    cold_utxo_table _cold_utxo = cold_utxo_table(_self, _self.value);
+    block_timeline_table _block_timeline = block_timeline_table(_self, _self.value);
+    pipeline_stats_table _pipeline_stats = pipeline_stats_table(_self, _self.value);
+
+    // `chainstate` as last read or written, so that `save_chain_state` only rewrites it when it differs
+    optional<chain_state_row> _stored_chain_state;
+
+    // remaining cost units of the current call
+    struct work_budget {
+        uint64_t remaining;
+        bool progressed = false;
+
+        bool available() const { return remaining > 0; }
+
+        // charge a row operation
+        void consume(const uint64_t cost) {
+            remaining = remaining > cost ? remaining - cost : 0;
+            progressed = true;
+        }
+
+        // charge overhead, leaving room for at least one row operation so that every call makes progress
+        void charge(const uint64_t cost) { remaining = remaining > cost ? remaining - cost : (progressed ? 0 : 1); }
+    };
     block_table _block = block_table(_self, _self.value);
     consensus_block_table _consensus_block = consensus_block_table(_self, _self.value);
 
     // private function
+    static work_budget get_work_budget(const work_cost_row &work_cost, uint64_t process_row);
+
+    chain_state_row get_chain_state();
+
+    void save_chain_state(const chain_state_row &chain_state);
+
+    chain_cursor_row get_chain_cursor(const chain_state_row &chain_state);
+
+    void save_chain_cursor(const chain_cursor_row &chain_cursor);
+
+    static bool is_same_chain_state(const chain_state_row &a, const chain_state_row &b);
+
+    checksum256 claim_parsing_block(const uint64_t height, const name &synchronizer,
+                                    const uint16_t parse_timeout_seconds);
+
+    parsing_progress_row new_parsing_progress(const uint64_t height, const checksum256 &hash, const uint64_t bucket_id,
+                                              const name &parser, const uint16_t parse_timeout_seconds);
+
+    bool migrate_legacy_progress(chain_state_row &chain_state);
+
+    void start_migration(chain_state_row &chain_state);
+
+    void save_parsing_block(const uint64_t height, const checksum256 &hash, const parsing_progress_row &progress);
+
+    void archive_block_header(const consensus_block_row &block);
+
+    void prune_forks(const chain_state_row &chain_state, const work_cost_row &work_cost, work_budget &budget);
+
+    bool is_losing_fork(const chain_state_row &chain_state, const consensus_block_row &block);
+
+    bool prune_fork_block(const consensus_block_row &block, const uint32_t erase_cost, work_budget &budget);
+
+    void freeze_utxos(const work_cost_row &work_cost, work_budget &budget);
+
+    void record_stage(const uint64_t height, const checksum256 &hash, const pipeline_stage stage,
+                      const uint64_t num_rows = 0);
+
+    optional<utxo_row> remove_cold_utxo(const checksum256 &txid, const uint32_t index, const work_cost_row &work_cost,
+                                        work_budget &budget);
+
+    optional<utxo_row> find_cold_utxo(const checksum256 &txid, const uint32_t index);
+
+    static utxo_row unpack_utxo(const packed_utxo &packed);
+
+    static std::vector<uint8_t> address_to_script(const string &address);
+
+    static optional<tx_proof> generate_tx_proof(const uint64_t bucket_id, const checksum256 &block_hash,
+                                                const checksum256 &merkle, const checksum256 &txid);
+
+    static uint64_t get_cold_bucket(const checksum256 &txid);
+
+    static uint64_t get_cold_bucket_cost(const work_cost_row &work_cost, const cold_utxo_row &cold_utxo);
+
+    void collect_garbage(const chain_state_row &chain_state, const config_row &config, const work_cost_row &work_cost,
+                         work_budget &call_budget);
+
+    void process_irreversible_block(chain_state_row &chain_state, const config_row &config,
+                                    const work_cost_row &work_cost, work_budget &budget);
+
+    bool parse_block(chain_state_row &chain_state, const checksum256 &hash, const name &synchronizer,
+                     const config_row &config, const work_cost_row &work_cost, work_budget &budget);
+
     void parsing_transactions(const uint64_t height, const checksum256 &hash, parsing_progress_row *parsing_progress,
-                              uint64_t process_row);
+                              const work_cost_row &work_cost, work_budget &budget);
 
-    void migrate(chain_state_row &chain_state, uint64_t process_row);
+    // returns true while the shards of the block are still being recorded @see `parsesplit`
+    bool split_parse_shards(parsing_progress_row *parsing_progress, const uint32_t num_txs_per_shard,
+                            const work_cost_row &work_cost, work_budget &budget);
+
+    void parsing_shard(const uint64_t height, const checksum256 &hash, const name &synchronizer,
+                       parsing_progress_row *parsing_progress, const uint16_t parse_timeout_seconds,
+                       const work_cost_row &work_cost, work_budget &budget);
+
+    void migrate(chain_state_row &chain_state, const work_cost_row &work_cost, work_budget &budget);
+
+    optional<utxo_row> remove_pending_vout(const pending_utxo_row &vin);
 
     void delete_data(utxo_manage::chain_state_row &chain_state, const uint16_t retained_spent_utxo_blocks,
-                     const uint16_t num_retain_data_blocks, uint64_t process_row);
+                     const uint16_t num_retain_data_blocks, const work_cost_row &work_cost, work_budget &budget);
 
     void find_set_next_parsable_block(chain_state_row &chain_state, const uint16_t parse_timeout_seconds);
 
@@ -937,17 +2276,37 @@ class [[eosio::contract("utxomng.xsat")]] utxo_manage : public contract {
 
     void save_spent_utxo(const uint64_t height, const utxo_manage::utxo_row &pending_utxo);
 
+    bool prune_spent_log(const uint64_t height, const uint32_t erase_cost, work_budget &budget);
+
     void save_pending_utxo(const uint64_t height, const checksum256 &hash, const checksum256 &txid,
                            const uint32_t index, const std::vector<uint8_t> &script_data, const uint64_t value,
                            const name &type);
 
     template <typename IDX>
-    optional<utxo_row> remove_utxo(IDX &utxo_idx, const checksum256 &prev_txid, const uint32_t prev_index);
+    optional<utxo_row> remove_utxo(IDX &utxo_idx, const checksum256 &prev_txid, const uint32_t prev_index,
+                                   xsat::muhash3072 &utxo_set_hash, const work_cost_row &work_cost,
+                                   work_budget &budget);
 
     utxo_row save_utxo(const checksum256 &txid, const uint32_t index, const std::vector<uint8_t> &script_data,
-                       const uint64_t value);
+                       const uint64_t value, xsat::muhash3072 &utxo_set_hash);
+
+    bool is_backfilled(const uint64_t utxo_id);
+
+    void backfill_utxos(const work_cost_row &work_cost, work_budget &budget);
+
+    xsat::muhash3072 get_utxo_set_hash();
+
+    void save_utxo_set_hash(const xsat::muhash3072 &utxo_set_hash);
+
+    void add_balance(const std::vector<uint8_t> &scriptpubkey, const uint64_t value);
+
+    void sub_balance(const std::vector<uint8_t> &scriptpubkey, const uint64_t value);
+
+    void count_cold_utxo(const std::vector<uint8_t> &scriptpubkey, const bool frozen);
                        
     bool is_endorsement_consensus_reached(const uint64_t height, const checksum256& hash);
+
+    void apply_consensus(const uint64_t height, const checksum256 &hash, const bool quorum_verified);
 #ifdef DEBUG
     template <typename T>
     void clear_table(T &table, uint64_t rows_to_clear);
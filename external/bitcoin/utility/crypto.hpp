@@ -82,4 +82,41 @@ namespace bitcoin {
         return generate_merkle_root(data, mutated);
     }
 
+    bitcoin::uint256_t merkle_parent(const bitcoin::uint256_t& left, const bitcoin::uint256_t& right) {
+        auto concatenated_hashes = std::array<uint8_t, 64>();
+        auto ds = eosio::datastream<uint8_t*>(concatenated_hashes.data(), concatenated_hashes.size());
+        ds << left << right;
+        return bitcoin::dhash(concatenated_hashes);
+    }
+
+    // siblings from the leaf at `index` up to the root, the same tree as generate_merkle_root
+    std::vector<bitcoin::uint256_t> generate_merkle_branch(std::vector<bitcoin::uint256_t> hashes, uint32_t index) {
+        std::vector<bitcoin::uint256_t> branch;
+        while (hashes.size() > 1) {
+            if (hashes.size() % 2 == 1) {
+                // odd number of hashes duplicate the last hash
+                hashes.push_back(hashes.back());
+            }
+            branch.push_back(hashes[index ^ 1]);
+
+            auto new_hashes = std::vector<bitcoin::uint256_t>();
+            new_hashes.reserve(hashes.size() / 2);
+            for (auto i = 0; i < hashes.size(); i += 2) {
+                new_hashes.push_back(merkle_parent(hashes[i], hashes[i + 1]));
+            }
+            hashes = std::move(new_hashes);
+            index >>= 1;
+        }
+        return branch;
+    }
+
+    bitcoin::uint256_t compute_merkle_root_from_branch(bitcoin::uint256_t hash,
+                                                       const std::vector<bitcoin::uint256_t>& branch, uint32_t index) {
+        for (const auto& sibling : branch) {
+            hash = (index & 1) ? merkle_parent(sibling, hash) : merkle_parent(hash, sibling);
+            index >>= 1;
+        }
+        return hash;
+    }
+
 }  // namespace bitcoin
\ No newline at end of file
@@ -168,6 +168,31 @@ describe('blkendt.xsat', () => {
         )
     })
 
+    it('endorses: missing required authority', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions
+                .endorses(['bob', 840000, ['0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5']])
+                .send('alice@active'),
+            'missing required authority bob'
+        )
+    })
+
+    it('endorsebatch: missing required authority', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions
+                .endorsebatch([840000, '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5', ['alice', 'bob']])
+                .send('alice@active'),
+            'missing required authority bob'
+        )
+    })
+
+    it('setcommittee: missing required authority', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.setcommittee([64]).send('alice@active'),
+            'missing required authority blkendt.xsat'
+        )
+    })
+
     it('endorse: height must be greater than 840000', async () => {
         await expectToThrow(
             contracts.blkendt.actions
@@ -0,0 +1,528 @@
+const { Asset, TimePointSec } = require('@greymass/eosio')
+const { Blockchain, log, expectToThrow } = require('@proton/vert')
+const { BTC, ZERO_XSAT } = require('./src/constants')
+
+// Vert EOS VM
+const blockchain = new Blockchain()
+//log.setLevel('debug');
+// contracts
+const contracts = {
+    blkendt: blockchain.createContract('blkendt.xsat', 'tests/wasm/blkendt.xsat', true),
+    endrmng: blockchain.createContract('endrmng.xsat', 'tests/wasm/endrmng.xsat', true),
+    utxomng: blockchain.createContract('utxomng.xsat', 'tests/wasm/utxomng.xsat', true),
+    btc: blockchain.createContract('btc.xsat', 'tests/wasm/btc.xsat', true),
+    rescmng: blockchain.createContract('rescmng.xsat', 'tests/wasm/rescmng.xsat', true),
+}
+
+blockchain.createAccounts('fees.xsat', 'alice', 'amy', 'anna', 'bob', 'brian', 'carol')
+
+const hashes = {
+    840001: '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463',
+    840002: '00000000000000000002c0cc73626b56fb3ee1ce605b0ce125cc4fb58775a0a9',
+    840003: '00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119',
+    840004: '000000000000000000028458274b1f458d57d817fdce349e31dd5cb51b277d36',
+    840005: '000000000000000000027b0ec0e3acadd018cd19e7dd976602f216a1bc12d079',
+    840006: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
+    840007: '000000000000000000030d1455700ec234e4214e75e8e1112632b74febe80c78',
+}
+
+const get_endorsements = height => {
+    return contracts.blkendt.tables.endorsements(BigInt(height)).getTableRows()
+}
+
+const get_votes = height => {
+    return get_endorsements(height)[0].votes
+}
+
+const get_vote_activities = () => {
+    return contracts.endrmng.tables.voteacts().getTableRows()
+}
+
+// stage_btc_quorum of utxomng.xsat, reported every time blkendt.xsat hands over a quorum
+const get_btc_quorum_metric = () => {
+    return contracts.utxomng.tables.pipestats().getTableRows()[0].stages[3]
+}
+
+// validator row imported with `imtvalidator`, the vote counters are the ones kept before `voteacts`
+const validator_row = (owner, staking, consecutive_vote_count = 0, latest_consensus_block = 0) => {
+    const quantity = Asset.from(staking, BTC).toString()
+    return {
+        owner,
+        reward_recipient: owner,
+        memo: '',
+        commission_rate: 0,
+        quantity,
+        qualification: quantity,
+        xsat_quantity: ZERO_XSAT,
+        donate_rate: 0,
+        total_donated: ZERO_XSAT,
+        stake_acc_per_share: 0,
+        consensus_acc_per_share: 0,
+        staking_reward_unclaimed: ZERO_XSAT,
+        staking_reward_claimed: ZERO_XSAT,
+        consensus_reward_unclaimed: ZERO_XSAT,
+        consensus_reward_claimed: ZERO_XSAT,
+        total_consensus_reward: ZERO_XSAT,
+        consensus_reward_balance: ZERO_XSAT,
+        total_staking_reward: ZERO_XSAT,
+        staking_reward_balance: ZERO_XSAT,
+        latest_staking_time: '1970-01-01T00:00:00',
+        latest_reward_block: 0,
+        latest_reward_time: '1970-01-01T00:00:00',
+        disabled_staking: false,
+        stake_address: '0000000000000000000000000000000000000000',
+        reward_address: '0000000000000000000000000000000000000000',
+        consecutive_vote_count,
+        latest_consensus_block,
+        active_flag: 1,
+        role: 0,
+        credit_weight_block: 0,
+        credit_weight: 0,
+    }
+}
+
+// one-time setup
+beforeAll(async () => {
+    blockchain.setTime(TimePointSec.from(new Date()))
+    await contracts.utxomng.actions
+        .init([
+            839999,
+            '0000000000000000000172014ba58d66455762add0512355ad651207918494ab',
+            '0000000000000000000000000000000000000000753b8c1eaae701e1f0146360',
+        ])
+        .send('utxomng.xsat@active')
+
+    // create BTC token
+    await contracts.btc.actions.create(['btc.xsat', '10000000.00000000 BTC']).send('btc.xsat@active')
+    await contracts.btc.actions.issue(['btc.xsat', '10000000.00000000 BTC', 'init']).send('btc.xsat@active')
+
+    // init
+    await contracts.rescmng.actions
+        .init({
+            cost_per_slot: '0.00000001 BTC',
+            cost_per_endorsement: '0.00000004 BTC',
+            cost_per_parse: '0.00000005 BTC',
+            cost_per_upload: '0.00000002 BTC',
+            cost_per_verification: '0.00000003 BTC',
+            fee_account: 'fees.xsat',
+        })
+        .send('rescmng.xsat@active')
+
+    // deposit fees
+    for (const account of ['alice', 'amy', 'anna', 'bob', 'brian']) {
+        await contracts.btc.actions.transfer(['btc.xsat', account, '100.00000000 BTC', '']).send('btc.xsat@active')
+        await contracts.btc.actions
+            .transfer([account, 'rescmng.xsat', '100.00000000 BTC', account])
+            .send(`${account}@active`)
+    }
+
+    // BTC validators, amy is below the 100 BTC qualification
+    await contracts.endrmng.actions
+        .imtvalidator([
+            [
+                validator_row('alice', 100),
+                validator_row('amy', 50),
+                validator_row('anna', 400),
+                validator_row('bob', 200),
+                validator_row('brian', 300),
+            ],
+        ])
+        .send('endrmng.xsat@active')
+
+    // XSAT consensus is not active below 900000
+    await contracts.blkendt.actions
+        .setqualify(['21000.00000000 XSAT', '100.00000000 BTC'])
+        .send('blkendt.xsat@active')
+    await contracts.blkendt.actions.setconheight([900000, 900000]).send('blkendt.xsat@active')
+    await contracts.blkendt.actions.config([0, 0, 3, 0, 0]).send('blkendt.xsat@active')
+})
+
+describe('blkendt.xsat votes', () => {
+    it('rebuildelig: missing required authority', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.rebuildelig([]).send('alice@active'),
+            'missing required authority endrmng.xsat'
+        )
+    })
+
+    it('rebuildelig', async () => {
+        await contracts.endrmng.actions.rebuildelig([]).send('endrmng.xsat@active')
+        expect(contracts.endrmng.tables.eligstate().getTableRows()[0]).toEqual({
+            epoch: 2,
+            btc_snapshot_id: 1,
+            xsat_snapshot_id: 2,
+        })
+        expect(contracts.endrmng.tables.eligibles().getTableRow(1n)).toEqual({
+            id: 1,
+            role: 0,
+            min_qualification: 10000000000,
+            validators: [
+                { account: 'alice', staking: 10000000000, active_flag: 1 },
+                { account: 'anna', staking: 40000000000, active_flag: 1 },
+                { account: 'bob', staking: 20000000000, active_flag: 1 },
+                { account: 'brian', staking: 30000000000, active_flag: 1 },
+            ],
+            superseded_at: '1970-01-01T00:00:00',
+        })
+    })
+
+    it('endorse: validator not in requested_validators list', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.endorse(['amy', 840001, hashes[840001]]).send('amy@active'),
+            'eosio_assert: 1005:blkendt.xsat::endorse: validator not in requested_validators list'
+        )
+    })
+
+    it('endorse: votes are recorded as bitmaps over the snapshot', async () => {
+        const height = 840001
+        await contracts.blkendt.actions.endorse(['alice', height, hashes[height]]).send('alice@active')
+        expect(get_endorsements(height)).toEqual([
+            {
+                id: 0,
+                hash: hashes[height],
+                requested_validators: [],
+                provider_validators: [],
+                votes: {
+                    validator_set_id: 1,
+                    requested: '0f',
+                    provided: '01',
+                    num_validators: 4,
+                    num_providers: 1,
+                    total_staking: 100000000000,
+                    provided_staking: 10000000000,
+                    consensus_staking: 0,
+                },
+            },
+        ])
+        // the snapshot is pinned while the endorsement references it
+        expect(contracts.blkendt.tables.valsetinfo().getTableRows()).toEqual([
+            { id: 1, num_validators: 4, last_height: height },
+        ])
+
+        await contracts.blkendt.actions.endorse(['bob', height, hashes[height]]).send('bob@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '0f',
+            provided: '05',
+            num_validators: 4,
+            num_providers: 2,
+            total_staking: 100000000000,
+            provided_staking: 30000000000,
+            consensus_staking: 0,
+        })
+
+        // 3 of 4 validators reach consensus
+        await contracts.blkendt.actions.endorse(['brian', height, hashes[height]]).send('brian@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '0f',
+            provided: '0d',
+            num_validators: 4,
+            num_providers: 3,
+            total_staking: 100000000000,
+            provided_staking: 60000000000,
+            consensus_staking: 60000000000,
+        })
+    })
+
+    it('endorse: validator is on the list of provider validators', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.endorse(['bob', 840001, hashes[840001]]).send('bob@active'),
+            'eosio_assert: 1006:blkendt.xsat::endorse: validator is on the list of provider validators'
+        )
+    })
+
+    it('endorses: the number of hashes must be between 1 and 32', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.endorses(['alice', 840002, []]).send('alice@active'),
+            'eosio_assert_message: 1010:blkendt.xsat::endorses: the number of hashes must be between 1 and 32'
+        )
+        await expectToThrow(
+            contracts.blkendt.actions
+                .endorses(['alice', 840002, Array(33).fill(hashes[840002])])
+                .send('alice@active'),
+            'eosio_assert_message: 1010:blkendt.xsat::endorses: the number of hashes must be between 1 and 32'
+        )
+    })
+
+    it('endorses: consecutive heights', async () => {
+        await contracts.blkendt.actions
+            .endorses(['alice', 840002, [hashes[840002], hashes[840003], hashes[840004]]])
+            .send('alice@active')
+        for (const height of [840002, 840003, 840004]) {
+            expect(get_endorsements(height)).toEqual([
+                {
+                    id: 0,
+                    hash: hashes[height],
+                    requested_validators: [],
+                    provider_validators: [],
+                    votes: {
+                        validator_set_id: 1,
+                        requested: '0f',
+                        provided: '01',
+                        num_validators: 4,
+                        num_providers: 1,
+                        total_staking: 100000000000,
+                        provided_staking: 10000000000,
+                        consensus_staking: 0,
+                    },
+                },
+            ])
+        }
+
+        await contracts.blkendt.actions
+            .endorses(['bob', 840002, [hashes[840002], hashes[840003]]])
+            .send('bob@active')
+        await contracts.blkendt.actions.endorses(['brian', 840002, [hashes[840002]]]).send('brian@active')
+        expect(get_votes(840002)).toEqual({
+            validator_set_id: 1,
+            requested: '0f',
+            provided: '0d',
+            num_validators: 4,
+            num_providers: 3,
+            total_staking: 100000000000,
+            provided_staking: 60000000000,
+            consensus_staking: 60000000000,
+        })
+        expect(get_votes(840003)).toEqual({
+            validator_set_id: 1,
+            requested: '0f',
+            provided: '05',
+            num_validators: 4,
+            num_providers: 2,
+            total_staking: 100000000000,
+            provided_staking: 30000000000,
+            consensus_staking: 0,
+        })
+
+        // the heights of an action are folded into the vote counters at once
+        expect(get_vote_activities()).toEqual([
+            { validator: 'alice', consecutive_vote_count: 4, latest_consensus_block: 840004 },
+            { validator: 'bob', consecutive_vote_count: 3, latest_consensus_block: 840003 },
+            { validator: 'brian', consecutive_vote_count: 2, latest_consensus_block: 840002 },
+        ])
+    })
+
+    it('endorses: a failed height reverts the whole action', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions
+                .endorses(['bob', 840003, [hashes[840003], hashes[840004]]])
+                .send('bob@active'),
+            'eosio_assert: 1006:blkendt.xsat::endorse: validator is on the list of provider validators'
+        )
+        expect(get_votes(840004).provided).toEqual('01')
+        expect(get_vote_activities()[1]).toEqual({
+            validator: 'bob',
+            consecutive_vote_count: 3,
+            latest_consensus_block: 840003,
+        })
+    })
+
+    it('endorsebatch: validators cannot be empty', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.endorsebatch([840005, hashes[840005], []]).send('alice@active'),
+            'eosio_assert: 1011:blkendt.xsat::endorsebatch: validators cannot be empty'
+        )
+    })
+
+    it('endorsebatch: a rejected validator reverts the whole bundle', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.endorsebatch([840005, hashes[840005], ['alice', 'amy']]).send([
+                { actor: 'alice', permission: 'active' },
+                { actor: 'amy', permission: 'active' },
+            ]),
+            'eosio_assert: 1005:blkendt.xsat::endorse: validator not in requested_validators list'
+        )
+        expect(get_endorsements(840005)).toEqual([])
+    })
+
+    it('endorsebatch: the quorum is dispatched once', async () => {
+        const height = 840005
+        const metric = get_btc_quorum_metric()
+
+        // consensus is reached by the third validator, the fourth must not hand the quorum over again
+        await contracts.blkendt.actions
+            .endorsebatch([height, hashes[height], ['alice', 'anna', 'bob', 'brian']])
+            .send([
+                { actor: 'alice', permission: 'active' },
+                { actor: 'anna', permission: 'active' },
+                { actor: 'bob', permission: 'active' },
+                { actor: 'brian', permission: 'active' },
+            ])
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '0f',
+            provided: '0f',
+            num_validators: 4,
+            num_providers: 4,
+            total_staking: 100000000000,
+            provided_staking: 100000000000,
+            consensus_staking: 70000000000,
+        })
+        expect(get_btc_quorum_metric().calls).toEqual(metric.calls + 1)
+        expect(get_btc_quorum_metric().samples).toEqual(metric.samples + 1)
+        expect(
+            contracts.utxomng.tables
+                .timelines()
+                .getTableRows()
+                .filter(row => row.height === height)
+                .map(row => row.hash)
+        ).toEqual([hashes[height]])
+
+        // every validator of the bundle has its vote recorded
+        expect(get_vote_activities()).toEqual([
+            { validator: 'alice', consecutive_vote_count: 5, latest_consensus_block: 840005 },
+            { validator: 'anna', consecutive_vote_count: 1, latest_consensus_block: 840005 },
+            { validator: 'bob', consecutive_vote_count: 1, latest_consensus_block: 840005 },
+            { validator: 'brian', consecutive_vote_count: 1, latest_consensus_block: 840005 },
+        ])
+    })
+
+    it('voteacts: counters of the validator row are used until the first vote', async () => {
+        await contracts.btc.actions.transfer(['btc.xsat', 'carol', '100.00000000 BTC', '']).send('btc.xsat@active')
+        await contracts.btc.actions.transfer(['carol', 'rescmng.xsat', '100.00000000 BTC', 'carol']).send('carol@active')
+        await contracts.endrmng.actions
+            .imtvalidator([[validator_row('carol', 50, 4, 840000)]])
+            .send('endrmng.xsat@active')
+        expect(get_vote_activities().find(row => row.validator === 'carol')).toBeUndefined()
+
+        // carol is not in the snapshot, the vote is only recorded by endrmng.xsat
+        const height = 840001
+        await contracts.blkendt.actions.endorse(['carol', height, hashes[height]]).send('carol@active')
+        expect(get_votes(height).provided).toEqual('0d')
+        expect(get_vote_activities().find(row => row.validator === 'carol')).toEqual({
+            validator: 'carol',
+            consecutive_vote_count: 5,
+            latest_consensus_block: 840001,
+        })
+
+        // the validator row is not rewritten by the vote
+        const validator = contracts.endrmng.tables
+            .validators()
+            .getTableRows()
+            .find(row => row.owner === 'carol')
+        expect(validator.consecutive_vote_count).toEqual(4)
+        expect(validator.latest_consensus_block).toEqual(840000)
+    })
+
+    it('voteacts: height must be greater than the latest consensus block', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.endorse(['carol', 840001, hashes[840001]]).send('carol@active'),
+            'eosio_assert: endrmng.xsat::endorse: height must be greater than the latest consensus block'
+        )
+    })
+
+    it('setcommittee: committee_size must be 0 or greater than or equal to min_validators', async () => {
+        await expectToThrow(
+            contracts.blkendt.actions.setcommittee([2]).send('blkendt.xsat@active'),
+            'eosio_assert: blkendt.xsat::setcommittee: committee_size must be 0 or greater than or equal to min_validators'
+        )
+    })
+
+    it('setcommittee', async () => {
+        await contracts.blkendt.actions.setcommittee([3]).send('blkendt.xsat@active')
+        expect(contracts.blkendt.tables.config().getTableRows()[0].committee_size).toEqual(3)
+    })
+
+    it('endorse: the committee is sampled by stake from the block hash', async () => {
+        const height = 840006
+        const metric = get_btc_quorum_metric()
+
+        // alice is not drawn for this block and opens the record without providing a vote
+        await contracts.blkendt.actions.endorse(['alice', height, hashes[height]]).send('alice@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '0e',
+            provided: '00',
+            num_validators: 3,
+            num_providers: 0,
+            total_staking: 90000000000,
+            provided_staking: 0,
+            consensus_staking: 0,
+        })
+
+        await contracts.blkendt.actions.endorse(['anna', height, hashes[height]]).send('anna@active')
+        await contracts.blkendt.actions.endorse(['bob', height, hashes[height]]).send('bob@active')
+        expect(get_btc_quorum_metric().calls).toEqual(metric.calls)
+
+        // the whole committee reaches consensus
+        await contracts.blkendt.actions.endorse(['brian', height, hashes[height]]).send('brian@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '0e',
+            provided: '0e',
+            num_validators: 3,
+            num_providers: 3,
+            total_staking: 90000000000,
+            provided_staking: 90000000000,
+            consensus_staking: 90000000000,
+        })
+        expect(get_btc_quorum_metric().calls).toEqual(metric.calls + 1)
+    })
+
+    it('endorse: every endorser derives the same committee', async () => {
+        const height = 840007
+
+        // a different block hash draws bob out of the committee
+        await contracts.blkendt.actions.endorse(['bob', height, hashes[height]]).send('bob@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '0b',
+            provided: '00',
+            num_validators: 3,
+            num_providers: 0,
+            total_staking: 80000000000,
+            provided_staking: 0,
+            consensus_staking: 0,
+        })
+
+        await contracts.blkendt.actions.endorse(['anna', height, hashes[height]]).send('anna@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '0b',
+            provided: '02',
+            num_validators: 3,
+            num_providers: 1,
+            total_staking: 80000000000,
+            provided_staking: 40000000000,
+            consensus_staking: 0,
+        })
+    })
+
+    it('setcommittee: 0 disables the committee', async () => {
+        await contracts.blkendt.actions.setcommittee([0]).send('blkendt.xsat@active')
+        expect(contracts.blkendt.tables.config().getTableRows()[0].committee_size).toEqual(0)
+    })
+
+    it('endorse: validators without consecutive votes are not requested', async () => {
+        const height = 840008
+        const hash = '0000000000000000000000000000000000000000000000000000000000840008'
+        await contracts.blkendt.actions.config([0, 0, 2, 0, 2]).send('blkendt.xsat@active')
+        await contracts.blkendt.actions.setconheight([height, height]).send('blkendt.xsat@active')
+
+        // alice and brian last voted at 840006, they never endorse this block and the quorum is still reached
+        await contracts.blkendt.actions.endorse(['anna', height, hash]).send('anna@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '06',
+            provided: '02',
+            num_validators: 2,
+            num_providers: 1,
+            total_staking: 60000000000,
+            provided_staking: 40000000000,
+            consensus_staking: 0,
+        })
+
+        await contracts.blkendt.actions.endorse(['bob', height, hash]).send('bob@active')
+        expect(get_votes(height)).toEqual({
+            validator_set_id: 1,
+            requested: '06',
+            provided: '06',
+            num_validators: 2,
+            num_providers: 2,
+            total_staking: 60000000000,
+            provided_staking: 60000000000,
+            consensus_staking: 60000000000,
+        })
+    })
+})
@@ -1473,4 +1473,11 @@ describe('endrmng.xsat', () => {
         expect(donate_after_balance - donate_before_balance).toEqual(1749999916)
     })
 
+    it('rebuildelig: missing required authority', async () => {
+        await expectToThrow(
+            contracts.endrmng.actions.rebuildelig([]).send('alice@active'),
+            'missing required authority endrmng.xsat'
+        )
+    })
+
 })
@@ -41,6 +41,64 @@ const get_miners = () => {
     return contracts.poolreg.tables.miners().getTableRows()
 }
 
+const get_active_stat = () => {
+    return contracts.poolreg.tables.activestat().getTableRows()[0]
+}
+
+const get_sync_expiry = () => {
+    return contracts.poolreg.tables.syncexpiry().getTableRows()
+}
+
+// number of active synchronizers derived from the counters, as revote reads them
+const count_active = head_height => {
+    const active_stat = get_active_stat()
+    let num_active = active_stat.num_unlimited + active_stat.num_limited
+    for (const row of get_sync_expiry().filter(row => row.height < head_height)) {
+        num_active -= row.num_synchronizers
+    }
+    return num_active
+}
+
+// number of active synchronizers from a scan of every synchronizer
+const scan_active = head_height => {
+    return contracts.poolreg.tables
+        .synchronizer()
+        .getTableRows()
+        .filter(row => {
+            const expiry_height = row.latest_produced_block_height + row.produced_block_limit
+            return row.produced_block_limit == 0 || head_height <= expiry_height
+        }).length
+}
+
+// syncexpiry rows expected from a scan of every synchronizer
+const scan_sync_expiry = pruned_height => {
+    const num_synchronizers = {}
+    for (const row of contracts.poolreg.tables.synchronizer().getTableRows()) {
+        const height = row.latest_produced_block_height + row.produced_block_limit
+        if (row.produced_block_limit == 0 || height < pruned_height) {
+            continue
+        }
+        num_synchronizers[height] = (num_synchronizers[height] || 0) + 1
+    }
+    return Object.keys(num_synchronizers)
+        .map(Number)
+        .sort((a, b) => a - b)
+        .map(height => ({ height, num_synchronizers: num_synchronizers[height] }))
+}
+
+const expect_active_counters = () => {
+    const pruned_height = get_active_stat().pruned_height
+    expect(get_sync_expiry()).toEqual(scan_sync_expiry(pruned_height))
+
+    // the head height is never below the pruned height
+    const head_heights = [
+        839999, 840431, 840432, 840433, 850000, 850110, 850111, 850432, 850532, 850533, 850632, 850633,
+    ]
+    for (const head_height of head_heights.filter(height => height >= pruned_height)) {
+        expect(count_active(head_height)).toEqual(scan_active(head_height))
+    }
+}
+
 // one-time setup
 beforeAll(async () => {
     blockchain.setTime(TimePointSec.from(new Date()))
@@ -147,6 +205,13 @@ describe('poolreg.xsat', () => {
         ])
     })
 
+    it('initactive: missing required authority', async () => {
+        await expectToThrow(
+            contracts.poolreg.actions.initactive([]).send('alice@active'),
+            'missing required authority poolreg.xsat'
+        )
+    })
+
     it('unbundle: missing required authority', async () => {
         await expectToThrow(
             contracts.poolreg.actions.unbundle([1]).send('alice@active'),
@@ -566,4 +631,42 @@ describe('poolreg.xsat', () => {
             },
         ])
     })
+
+    it('initactive', async () => {
+        expect(get_active_stat()).toEqual(undefined)
+        await contracts.poolreg.actions.initactive([]).send('poolreg.xsat@active')
+        expect(get_active_stat().pruned_height).toEqual(0)
+        expect_active_counters()
+    })
+
+    it('initactive: counters follow updateheight', async () => {
+        await contracts.poolreg.actions
+            .updateheight(['brian', 850100, ['1KGG9kvV5zXiqyQAMfY32sGt9eFLMmgpgX']])
+            .send('utxomng.xsat@active')
+        // synchronizers expiring below the latest produced height are pruned
+        expect(get_active_stat().pruned_height).toEqual(850100)
+        expect_active_counters()
+
+        await contracts.poolreg.actions
+            .updateheight(['amy', 850200, ['1BM1sAcrfV6d4zPKytzziu4McLQDsFC2Qc']])
+            .send('utxomng.xsat@active')
+        expect(get_active_stat().pruned_height).toEqual(850200)
+        expect_active_counters()
+    })
+
+    it('initactive: counters follow config', async () => {
+        await contracts.poolreg.actions.config(['brian', 10]).send('poolreg.xsat@active')
+        expect_active_counters()
+        await contracts.poolreg.actions.config(['amy', 0]).send('poolreg.xsat@active')
+        expect_active_counters()
+        await contracts.poolreg.actions.config(['bob', 432]).send('poolreg.xsat@active')
+        expect_active_counters()
+    })
+
+    it('initactive: counters follow delpool', async () => {
+        await contracts.poolreg.actions.delpool(['amy']).send('poolreg.xsat@active')
+        expect_active_counters()
+        await contracts.poolreg.actions.delpool(['brian']).send('poolreg.xsat@active')
+        expect_active_counters()
+    })
 })
@@ -34,6 +34,99 @@ const decodeReturn_verify = returnValue => {
     }
 }
 
+// reads the fields of a serialized return value in order
+const returnReader = returnValue => {
+    let offset = 0
+    const read_varuint32 = () => {
+        let value = 0
+        let shift = 0
+        while (true) {
+            const byte = returnValue[offset++]
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if ((byte & 0x80) == 0) return value >>> 0
+        }
+    }
+    const read_bytes = size => {
+        const bytes = returnValue.subarray(offset, offset + size).toString('hex')
+        offset += size
+        return bytes
+    }
+    const read_uint32 = () => {
+        const value = returnValue.readUInt32LE(offset)
+        offset += 4
+        return value
+    }
+    const read_uint64 = () => {
+        const value = Number(returnValue.readBigUInt64LE(offset))
+        offset += 8
+        return value
+    }
+    const remaining = () => returnValue.length - offset
+    return { read_varuint32, read_bytes, read_uint32, read_uint64, remaining }
+}
+
+const decodeReturn_gettxproof = returnValue => {
+    const { read_varuint32, read_bytes, read_uint32 } = returnReader(returnValue)
+
+    const block_hash = read_bytes(32)
+    const merkle = read_bytes(32)
+    const index = read_uint32()
+    const raw_transaction = read_bytes(read_varuint32())
+    const branch = []
+    for (let num_branch = read_varuint32(); num_branch > 0; num_branch--) {
+        branch.push(read_bytes(32))
+    }
+    return { block_hash, merkle, index, raw_transaction, branch }
+}
+
+// utxomng.xsat utxo_row vector
+const read_utxos = ({ read_varuint32, read_bytes, read_uint32, read_uint64 }) => {
+    const utxos = []
+    for (let num_utxos = read_varuint32(); num_utxos > 0; num_utxos--) {
+        const id = read_uint64()
+        const txid = read_bytes(32)
+        const index = read_uint32()
+        const scriptpubkey = read_bytes(read_varuint32())
+        const value = read_uint64()
+        utxos.push({ id, txid, index, scriptpubkey, value })
+    }
+    return utxos
+}
+
+const decodeReturn_getoutpoints = returnValue => {
+    return read_utxos(returnReader(returnValue))
+}
+
+const decodeReturn_utxo_page = returnValue => {
+    const reader = returnReader(returnValue)
+    const utxos = read_utxos(reader)
+    const next_cursor = reader.read_uint64()
+    const cold_omitted = reader.read_bytes(1) == '01'
+    return { utxos, next_cursor, cold_omitted }
+}
+
+const decodeReturn_getbalance = returnValue => {
+    const { read_bytes, read_uint64, remaining } = returnReader(returnValue)
+    const id = read_uint64()
+    const scripthash = read_bytes(32)
+    const value = read_uint64()
+    const num_utxos = read_uint64()
+    if (remaining() == 0) {
+        return { id, scripthash, value, num_utxos }
+    }
+    return { id, scripthash, value, num_utxos, num_cold_utxos: read_uint64() }
+}
+
+const decodeReturn_scripttoaddr = returnValue => {
+    const { read_varuint32, read_bytes } = returnReader(returnValue)
+    const addresses = []
+    for (let num_addresses = read_varuint32(); num_addresses > 0; num_addresses--) {
+        addresses.push(Buffer.from(read_bytes(read_varuint32()), 'hex').toString())
+    }
+    return addresses
+}
+
 const max_chunk_size = 512 * 1024
 
 module.exports = {
@@ -41,5 +134,10 @@ module.exports = {
     addTime,
     subTime,
     decodeReturn_verify,
+    decodeReturn_gettxproof,
+    decodeReturn_getoutpoints,
+    decodeReturn_utxo_page,
+    decodeReturn_getbalance,
+    decodeReturn_scripttoaddr,
     max_chunk_size,
 }
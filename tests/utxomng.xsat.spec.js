@@ -1,9 +1,19 @@
-const { TimePointSec } = require('@greymass/eosio')
+const { Name, TimePointSec } = require('@greymass/eosio')
 const { Blockchain, expectToThrow } = require('@proton/vert')
 const { BTC, BTC_CONTRACT } = require('./src/constants')
 const fs = require('fs')
 const path = require('path')
-const { addTime, decodeReturn_verify, max_chunk_size } = require('./src/help')
+const crypto = require('crypto')
+const {
+    addTime,
+    decodeReturn_verify,
+    decodeReturn_gettxproof,
+    decodeReturn_getoutpoints,
+    decodeReturn_utxo_page,
+    decodeReturn_getbalance,
+    decodeReturn_scripttoaddr,
+    max_chunk_size,
+} = require('./src/help')
 
 // Vert EOS VM
 const blockchain = new Blockchain()
@@ -20,6 +30,8 @@ const contracts = {
     btc: blockchain.createContract('btc.xsat', 'tests/wasm/btc.xsat', true),
     exsat: blockchain.createContract('exsat.xsat', 'tests/wasm/exsat.xsat', true),
     rwddist: blockchain.createContract('rwddist.xsat', 'tests/wasm/rwddist.xsat', true),
+    gasfund: blockchain.createContract('gasfund.xsat', 'tests/wasm/gasfund.xsat', true),
+    custody: blockchain.createContract('custody.xsat', 'tests/wasm/custody.xsat', true),
 }
 
 // accounts
@@ -31,8 +43,11 @@ const get_utxo = id => {
     return contracts.utxomng.tables.utxos().getTableRow(BigInt(id))
 }
 
+// chainstate with the per-call fields kept in chaincursor
 const get_chain_state = () => {
-    return contracts.utxomng.tables.chainstate().getTableRows()[0]
+    const chain_state = contracts.utxomng.tables.chainstate().getTableRows()[0]
+    const chain_cursor = contracts.utxomng.tables.chaincursor().getTableRows()[0]
+    return { ...chain_state, ...chain_cursor }
 }
 
 const get_consensus_block = bucket_id => {
@@ -51,6 +66,123 @@ const get_config = () => {
     return contracts.utxomng.tables.config().getTableRows()[0]
 }
 
+const get_balance = id => {
+    return contracts.utxomng.tables.balances().getTableRow(BigInt(id))
+}
+
+const get_parsing_blocks = () => {
+    return contracts.utxomng.tables.parsingblks().getTableRows()
+}
+
+const get_utxo_set = () => {
+    return contracts.utxomng.tables.utxoset().getTableRows()[0]
+}
+
+const get_work_cost = () => {
+    return contracts.utxomng.tables.workcost().getTableRows()[0]
+}
+
+const sha256 = data => crypto.createHash('sha256').update(data).digest()
+
+// xsat::utils::compress_script tags, anything else is stored as is after 0xff
+const script_templates = [
+    ['00', '76a914', '88ac', 40],
+    ['01', 'a914', '87', 40],
+    ['02', '0014', '', 40],
+    ['03', '0020', '', 64],
+    ['04', '5120', '', 64],
+]
+
+const compress_script = scriptpubkey => {
+    for (const [tag, prefix, suffix, length] of script_templates) {
+        if (
+            scriptpubkey.length == prefix.length + length + suffix.length &&
+            scriptpubkey.startsWith(prefix) &&
+            scriptpubkey.endsWith(suffix)
+        ) {
+            return tag + scriptpubkey.substring(prefix.length, prefix.length + length)
+        }
+    }
+    return 'ff' + scriptpubkey
+}
+
+const decompress_script = script => {
+    const template = script_templates.find(([tag]) => tag == script.substring(0, 2))
+    if (!template) {
+        return script.substring(2)
+    }
+    const [, prefix, suffix] = template
+    return prefix + script.substring(2) + suffix
+}
+
+// the packed utxos of every coldutxos bucket, expanded to utxos rows
+const get_cold_utxos = () => {
+    return contracts.utxomng.tables
+        .coldutxos()
+        .getTableRows()
+        .flatMap(({ utxos }) =>
+            utxos.map(({ id, txid, index, value, script }) => ({
+                id,
+                txid,
+                index,
+                scriptpubkey: decompress_script(script),
+                value,
+            }))
+        )
+}
+
+// MuHash3072 element of a utxo, the 384 bytes of sha256(digest || i) read as a little-endian number
+const MUHASH_PRIME = (1n << 3072n) - 1103717n
+const from_le_hex = hex => (hex.length ? BigInt('0x' + Buffer.from(hex, 'hex').reverse().toString('hex')) : 1n)
+const muhash_element = utxo => {
+    const index_value = Buffer.alloc(12)
+    index_value.writeUInt32LE(utxo.index, 0)
+    index_value.writeBigUInt64LE(BigInt(utxo.value), 4)
+    const digest = sha256(
+        Buffer.concat([Buffer.from(utxo.txid, 'hex'), index_value, Buffer.from(utxo.scriptpubkey, 'hex')])
+    )
+    const blocks = []
+    for (let i = 0; i < 12; i++) {
+        blocks.push(sha256(Buffer.concat([digest, Buffer.from([i])])))
+    }
+    return from_le_hex(Buffer.concat(blocks).toString('hex')) % MUHASH_PRIME
+}
+
+// balances and the utxo set hash must describe exactly the utxos in utxos and coldutxos
+const expect_utxo_set = (hot_utxos, cold_utxos) => {
+    const balances = new Map()
+    const add_balance = (utxo, cold) => {
+        const scripthash = sha256(Buffer.from(utxo.scriptpubkey, 'hex')).toString('hex')
+        const balance = balances.get(scripthash) ?? { scripthash, value: 0, num_utxos: 0, num_cold_utxos: 0 }
+        balance.value += utxo.value
+        balance.num_utxos += 1
+        balance.num_cold_utxos += cold ? 1 : 0
+        balances.set(scripthash, balance)
+    }
+    hot_utxos.forEach(utxo => add_balance(utxo, false))
+    cold_utxos.forEach(utxo => add_balance(utxo, true))
+
+    const by_scripthash = (a, b) => (a.scripthash < b.scripthash ? -1 : 1)
+    const balance_rows = contracts.utxomng.tables
+        .balances()
+        .getTableRows()
+        .map(({ scripthash, value, num_utxos, num_cold_utxos }) => ({
+            scripthash,
+            value,
+            num_utxos,
+            num_cold_utxos: num_cold_utxos ?? 0,
+        }))
+    expect(balance_rows.sort(by_scripthash)).toEqual([...balances.values()].sort(by_scripthash))
+
+    // numerator / denominator is the product of the elements of the set
+    const { numerator, denominator } = get_utxo_set()
+    const product = [...hot_utxos, ...cold_utxos].reduce(
+        (product, utxo) => (product * muhash_element(utxo)) % MUHASH_PRIME,
+        1n
+    )
+    expect(from_le_hex(numerator)).toEqual((from_le_hex(denominator) * product) % MUHASH_PRIME)
+}
+
 const pushUpload = async (sender, height, hash, block) => {
     const chunks = []
     let next_offset = 0
@@ -72,6 +204,31 @@ const pushChunk = (sender, height, hash, chunk_id, chunk) => {
 
 const get_nonce = () => new Date().getTime()
 
+// the 56th transaction of 840002 and its merkle branch
+const spv_proof_txid = '38748199cd0414c2f0a136922c82e46554315df2d0eb1315d4c398cdeca0a327'
+const spv_proof = {
+    account: 'amy',
+    height: 840002,
+    index: 55,
+    raw_transaction:
+        '020000000001013981f4d1b21a6fdad734b1ed579f649c7fe79d8d4893a80255c8ba8028bcec210100000000ffffffff02d0480a0000000000225120b0ae70c4d7082361d892959941637bc5a15d1ff8e4178a183c3928fee9841585034b3c000000000016001432d8ff292a8730f32b6506c95743b06d31182da402483045022100ba69383b8d930462bbde8719124639d3cd4bbd60bfa9dbe409f3febb13ac728e02207e05397cc6404787123f33c7b13f06c880775e8f2603a997183d581c956e803801210398c6735364c9266fe45268925edeb247f8e3707f6f5c34481f283e1464e2c81700000000',
+    branch: [
+        'b6c059c1d5dbcaf949e40945560f60ff4bfbdfe8cbcf908ddc90f68b9ff20e16',
+        'a8e6d785fe25b275e93e684558946d8163f81fddf48c65c149366d1b247db5fd',
+        'a6997cea5f96978ed2ca8a4934255822b9b776c4b35ce1f26d4989d51a8b6fbc',
+        '18468cdc61a361188dbd374e5859a8511dff184b9c1ff60fa6b03ede9bd165f6',
+        '5fedb74ce2b0c56766a217d6fdac1fb1815d30f594db3a4a0df9370a4804a43b',
+        '1962c111a1846ac96173f59b60da9aae4852166937c5983f6e3ef19d67fc3d39',
+        '83cded373d34ba4b83170cd5d9bfb023a9ede78cb59d44c37548a426f1349d54',
+        '61baefbf2d63bdd85d05044c12340bd37663c359397beb99382f37c12fc7d7a5',
+        'd76b9004d8437c9922a887b0c58f87a4f716c6342378570814f93e1a59a7cad4',
+        'ffef955615fe5136f407c47b6f53e710f610c86d6b929e55566931ffcd5994c1',
+        'f3b38801d942ebdc882ba9d1528919600bd24a6a8393ee3adf753a590b08ab03',
+        'dc7d177bfe7f7b43b7035ec6f910d86eb072998cb0afc14b8ac35dadad82d3e6',
+        'b17b59d0fb85f4bccfc5128e912ea5d9beaf1067b4dadcf58de74996c4ce70b5',
+    ],
+}
+
 // one-time setup
 beforeAll(async () => {
     blockchain.setTime(TimePointSec.from(new Date()))
@@ -194,6 +351,33 @@ describe('utxomng.xsat', () => {
         )
     })
 
+    it('getbalance: balances are still being backfilled', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.getbalance(['18cBEMRxXHqzWWCxZNtU91F5sbUNKhL5PX']).send('alice'),
+            'eosio_assert: 4018:utxomng.xsat::getbalance: balances are still being backfilled'
+        )
+    })
+
+    it('initbackfill: missing required authority', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.initbackfill([]).send('alice'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('initbackfill', async () => {
+        await contracts.utxomng.actions.initbackfill([]).send('utxomng.xsat')
+        expect(contracts.utxomng.tables.backfill().getTableRows()[0]).toEqual({
+            end_id: 0,
+            next_id: 0,
+            completed: true,
+        })
+        await expectToThrow(
+            contracts.utxomng.actions.initbackfill([]).send('utxomng.xsat'),
+            'eosio_assert: utxomng.xsat::initbackfill: backfill has already been initialized'
+        )
+    })
+
     it('addutxo', async () => {
         const utxo = {
             id: 1,
@@ -209,6 +393,26 @@ describe('utxomng.xsat', () => {
         await contracts.utxomng.actions.addutxo(utxo).send('utxomng.xsat@active')
         expect(get_utxo(1)).toEqual(utxo)
         expect(get_chain_state().num_utxos).toEqual(1)
+        expect(get_balance(0)).toEqual({
+            id: 0,
+            scripthash: '68616b4e3a395a51a095185b74890179a530268e0d43bc148c98f19e4aafe449',
+            value: 4075061499,
+            num_utxos: 1,
+        })
+        // the commitment is only published for migrated blocks
+        const utxo_set = get_utxo_set()
+        expect(utxo_set.commitment).toEqual('0000000000000000000000000000000000000000000000000000000000000000')
+        expect(utxo_set.numerator.length).toEqual(768)
+        expect(utxo_set.numerator).not.toEqual(utxo_set.denominator)
+    })
+
+    it('utxosbyscrpt: limit must be between 1 and 1000', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .utxosbyscrpt(['76a914536ffa992491508dca0354e52f32a3a7a679a53a88ac', 0, 0])
+                .send('alice'),
+            'eosio_assert: 4014:utxomng.xsat::utxosbyscrpt: limit must be between 1 and 1000'
+        )
     })
 
     it('delutxo: missing required authority utxomng.xsat', async () => {
@@ -218,6 +422,20 @@ describe('utxomng.xsat', () => {
         )
     })
 
+    it('qconsensus: missing required authority blkendt.xsat', async () => {
+        const quorum = { validator_set_id: 0, num_validators: 1, num_providers: 1, total_staking: 1, provided_staking: 1 }
+        await expectToThrow(
+            contracts.utxomng.actions
+                .qconsensus([
+                    840000,
+                    '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
+                    { btc: quorum, xsat: null },
+                ])
+                .send('alice@active'),
+            'missing required authority blkendt.xsat'
+        )
+    })
+
     it('delutxo: [utxos] does not exist', async () => {
         await expectToThrow(
             contracts.utxomng.actions.delutxo([840000]).send('utxomng.xsat@active'),
@@ -228,25 +446,55 @@ describe('utxomng.xsat', () => {
     it('delutxo', async () => {
         await contracts.utxomng.actions.delutxo([1]).send('utxomng.xsat@active')
         expect(get_utxo(1)).toEqual(undefined)
-        expect(get_chain_state()).toEqual({
-            head_height: 0,
-            irreversible_height: 0,
-            irreversible_hash: '0000000000000000000000000000000000000000000000000000000000000000',
-            num_utxos: 0,
-            migrating_height: 0,
-            migrating_hash: '0000000000000000000000000000000000000000000000000000000000000000',
-            migrating_num_utxos: 0,
-            migrated_num_utxos: 0,
-            parsed_height: 0,
-            parsing_height: 0,
-            parsing_progress_of: [],
-            status: 0,
-            synchronizer: '',
-            miner: '',
-            parser: '',
-            num_validators_assigned: 0,
-            num_provider_validators: 0,
+        expect(get_balance(0)).toEqual(undefined)
+        // the set is empty again
+        expect(get_utxo_set().numerator).toEqual(get_utxo_set().denominator)
+        // utxo imports only update the cursor
+        expect(contracts.utxomng.tables.chainstate().getTableRows()).toEqual([])
+        expect(contracts.utxomng.tables.chaincursor().getTableRows()).toEqual([
+            {
+                num_utxos: 0,
+                migrated_num_utxos: 0,
+                num_validators_assigned: 0,
+                status: 0,
+            },
+        ])
+    })
+
+    it('importutxos: batch commitment mismatch', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .importutxos([
+                    1,
+                    'c323eae524ce3b49f0868396eb9a61bea0e5fb3dc2e52cb46e04c2dba28a3c0d010000004f01f5250000000016001435f6de260c9f3bdee47524c473a6016c0c055cb9',
+                    '0000000000000000000000000000000000000000000000000000000000000000',
+                ])
+                .send('utxomng.xsat@active'),
+            'eosio_assert: utxomng.xsat::importutxos: batch commitment mismatch'
+        )
+    })
+
+    it('importutxos', async () => {
+        await contracts.utxomng.actions
+            .importutxos([
+                1,
+                'c323eae524ce3b49f0868396eb9a61bea0e5fb3dc2e52cb46e04c2dba28a3c0d010000004f01f5250000000016001435f6de260c9f3bdee47524c473a6016c0c055cb9',
+                '6c0862a56faa0e4c531e0c076fb7821abe65d4582c3dbaf9c6647f7102b0e099',
+            ])
+            .send('utxomng.xsat@active')
+        expect(get_utxo(1)).toEqual({
+            id: 1,
+            txid: 'c323eae524ce3b49f0868396eb9a61bea0e5fb3dc2e52cb46e04c2dba28a3c0d',
+            index: 1,
+            scriptpubkey: '001435f6de260c9f3bdee47524c473a6016c0c055cb9',
+            value: 636813647,
         })
+        expect(get_chain_state().num_utxos).toEqual(1)
+        expect(get_utxo_set().numerator).not.toEqual(get_utxo_set().denominator)
+
+        await contracts.utxomng.actions.delutxo([1]).send('utxomng.xsat@active')
+        expect(get_chain_state().num_utxos).toEqual(0)
+        expect(get_utxo_set().numerator).toEqual(get_utxo_set().denominator)
     })
 
     it('addblock: missing required authority utxomng.xsat', async () => {
@@ -428,6 +676,79 @@ describe('utxomng.xsat', () => {
         })
     })
 
+    it('setworkcost: missing required authority', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setworkcost([0, 1, 0, 0, 0, 1, 0]).send('alice'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('setworkcost: pending_emplace must be greater than 0', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setworkcost([0, 0, 0, 0, 0, 1, 0]).send('utxomng.xsat'),
+            'eosio_assert: utxomng.xsat::setworkcost: pending_emplace must be greater than 0'
+        )
+    })
+
+    it('setcoldtier: missing required authority', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setcoldtier([0, 500]).send('alice'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('setcoldtier: max_frozen_utxos must be greater than 0', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setcoldtier([0, 0]).send('utxomng.xsat'),
+            'eosio_assert: utxomng.xsat::setcoldtier: max_frozen_utxos must be greater than 0'
+        )
+    })
+
+    it('setcoldtier', async () => {
+        await contracts.utxomng.actions.setcoldtier([0, 500]).send('utxomng.xsat')
+        expect(contracts.utxomng.tables.coldtier().getTableRows()[0]).toEqual({
+            retained_hot_utxos: 0,
+            max_frozen_utxos: 500,
+            frozen_id: 0,
+        })
+    })
+
+    it('setgcconfig: missing required authority', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setgcconfig([4320, 4320, 5, 500]).send('alice'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('setgcconfig: max_rows must be greater than 0', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setgcconfig([4320, 4320, 5, 0]).send('utxomng.xsat'),
+            'eosio_assert: utxomng.xsat::setgcconfig: max_rows must be greater than 0'
+        )
+    })
+
+    it('recordstage: missing required authority', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .recordstage([840000, '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5', 0])
+                .send('alice'),
+            'missing required authority blkendt.xsat'
+        )
+    })
+
+    it('setworkcost', async () => {
+        await contracts.utxomng.actions.setworkcost([0, 1, 0, 0, 0, 1, 0]).send('utxomng.xsat')
+        expect(get_work_cost()).toEqual({
+            budget: 0,
+            pending_emplace: 1,
+            remove_utxo: 0,
+            save_utxo: 0,
+            save_spent_utxo: 0,
+            pending_erase: 1,
+            deserialize_kbytes: 0,
+        })
+    })
+
     it('consensus: 839999', async () => {
         await contracts.utxomng.actions
             .addblock({
@@ -479,22 +800,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 0,
             parsed_height: 839999,
             parsing_height: 840000,
-            parsing_progress_of: [
-                {
-                    first: hash,
-                    second: {
-                        bucket_id: 1,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'bob',
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: '',
             miner: '',
             parser: '',
@@ -502,6 +808,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 0,
             status: 1,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840000,
+                hash: hash,
+                progress: {
+                    bucket_id: 1,
+                    num_utxos: 0,
+                    num_transactions: 0,
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 0,
+                    parsed_vout: 0,
+                    parser: 'bob',
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                },
+            },
+        ])
     })
 
     it('parse 840000', async () => {
@@ -518,22 +841,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 0,
             parsed_height: 839999,
             parsing_height: 840000,
-            parsing_progress_of: [
-                {
-                    first: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
-                    second: {
-                        bucket_id: 1,
-                        num_transactions: 3050,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 1,
-                        parsed_vout: 0,
-                        parser: 'bob',
-                        num_utxos: 0,
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: '',
             miner: '',
             parser: '',
@@ -541,6 +849,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 0,
             status: 5,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840000,
+                hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
+                progress: {
+                    bucket_id: 1,
+                    num_transactions: 3050,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 1,
+                    parsed_vout: 0,
+                    parser: 'bob',
+                    num_utxos: 0,
+                },
+            },
+        ])
 
         await contracts.utxomng.actions.processblock(['bob', 1, get_nonce()]).send('bob@active')
         expect(get_chain_state()).toEqual({
@@ -554,22 +879,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 0,
             parsed_height: 839999,
             parsing_height: 840000,
-            parsing_progress_of: [
-                {
-                    first: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
-                    second: {
-                        bucket_id: 1,
-                        num_utxos: 1,
-                        num_transactions: 3050,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 1,
-                        parsed_vout: 1,
-                        parser: 'bob',
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: '',
             miner: '',
             parser: '',
@@ -577,6 +887,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 0,
             status: 5,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840000,
+                hash: '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5',
+                progress: {
+                    bucket_id: 1,
+                    num_utxos: 1,
+                    num_transactions: 3050,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 1,
+                    parsed_vout: 1,
+                    parser: 'bob',
+                },
+            },
+        ])
 
         await contracts.utxomng.actions.processblock(['bob', 0, get_nonce()]).send('bob@active')
         expect(get_chain_state()).toEqual({
@@ -640,22 +967,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 0,
             parsed_height: 840000,
             parsing_height: 840001,
-            parsing_progress_of: [
-                {
-                    first: hash,
-                    second: {
-                        bucket_id: 2,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'alice',
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: '',
             miner: '',
             parser: '',
@@ -663,6 +975,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 0,
             status: 1,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840001,
+                hash: hash,
+                progress: {
+                    bucket_id: 2,
+                    num_utxos: 0,
+                    num_transactions: 0,
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 0,
+                    parsed_vout: 0,
+                    parser: 'alice',
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                },
+            },
+        ])
     })
 
     it('parse 840001: you are not a parser of the current block', async () => {
@@ -706,6 +1035,39 @@ describe('utxomng.xsat', () => {
         )
     })
 
+    it('chaincursor', async () => {
+        const chain_state = contracts.utxomng.tables.chainstate().getTableRows()[0]
+        expect(chain_state.num_utxos).toEqual(0)
+        expect(chain_state.migrated_num_utxos).toEqual(0)
+        expect(chain_state.num_validators_assigned).toEqual(0)
+        expect(chain_state.status).toEqual(0)
+        expect(contracts.utxomng.tables.chaincursor().getTableRows()[0]).toEqual({
+            num_utxos: get_chain_state().num_utxos,
+            migrated_num_utxos: get_chain_state().migrated_num_utxos,
+            num_validators_assigned: get_chain_state().num_validators_assigned,
+            status: get_chain_state().status,
+        })
+    })
+
+    it('custody: enroll before 840002', async () => {
+        expect(get_chain_state().head_height).toEqual(840001)
+        await contracts.custody.actions.enroll(['amy']).send('amy@active')
+        // 840002 pays 3951363 satoshis to bc1qxtv072f2suc0x2m9qmy4wsasd5c3stdy582nmt in its 56th transaction
+        await contracts.custody.actions.modifyrandom(['amy', 3951363]).send('custody.xsat@active')
+        await contracts.custody.actions
+            .verifytx([
+                'amy',
+                'bc1qxtv072f2suc0x2m9qmy4wsasd5c3stdy582nmt',
+                '38748199cd0414c2f0a136922c82e46554315df2d0eb1315d4c398cdeca0a327',
+                '',
+            ])
+            .send('amy@active')
+        const enrollment = contracts.custody.tables.enrollments().getTableRow(BigInt(Name.from('amy').value.value))
+        expect(enrollment.random).toEqual(3951363)
+        expect(enrollment.start_height).toEqual(840001)
+        expect(enrollment.is_valid).toEqual(0)
+    })
+
     it('consensus 840002', async () => {
         const height = 840002
         const hash = '00000000000000000002c0cc73626b56fb3ee1ce605b0ce125cc4fb58775a0a9'
@@ -819,6 +1181,27 @@ describe('utxomng.xsat', () => {
             if (retval.status == 'verify_pass') break
         }
 
+        // the verified block is parsed before it reaches consensus
+        await contracts.utxomng.actions.specparse(['alice', height, hash, 2, get_nonce()]).send('alice@active')
+        expect(contracts.utxomng.tables.specparsing().getTableRows()).toEqual([
+            {
+                id: 0,
+                height,
+                hash,
+                progress: {
+                    bucket_id: 7,
+                    num_utxos: 1,
+                    num_transactions: 4837,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 1,
+                    parsed_vout: 1,
+                    parser: 'alice',
+                },
+            },
+        ])
+
         blockchain.addTime(TimePointSec.from(1000))
         await contracts.blkendt.actions.endorse(['amy', height, hash]).send('amy@active')
         await contracts.blkendt.actions.endorse(['anna', height, hash]).send('anna@active')
@@ -826,6 +1209,51 @@ describe('utxomng.xsat', () => {
         await contracts.blkendt.actions.endorse(['bob', height, hash]).send('bob@active')
     })
 
+    it('specparse: the block is already irreversible', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .specparse([
+                    'alice',
+                    839999,
+                    '0000000000000000000172014ba58d66455762add0512355ad651207918494ab',
+                    0,
+                    get_nonce(),
+                ])
+                .send('alice@active'),
+            'eosio_assert: 4008:utxomng.xsat::specparse: the block is already irreversible'
+        )
+    })
+
+    it('specparse: the block has reached consensus, use processblock', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .specparse([
+                    'alice',
+                    840006,
+                    '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
+                    0,
+                    get_nonce(),
+                ])
+                .send('alice@active'),
+            'eosio_assert: 4009:utxomng.xsat::specparse: the block has reached consensus, use processblock'
+        )
+    })
+
+    it('specparse: the block has not passed verification', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .specparse([
+                    'alice',
+                    840008,
+                    '0000000000000000000000000000000000000000000000000000000000000001',
+                    0,
+                    get_nonce(),
+                ])
+                .send('alice@active'),
+            'eosio_assert: 4010:utxomng.xsat::specparse: the block has not passed verification'
+        )
+    })
+
     it('consensus 840007', async () => {
         const height = 840007
         const hash = '000000000000000000030d1455700ec234e4214e75e8e1112632b74febe80c78'
@@ -864,22 +1292,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 0,
             parsed_height: 840002,
             parsing_height: 840003,
-            parsing_progress_of: [
-                {
-                    first: '00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119',
-                    second: {
-                        bucket_id: 4,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'alice',
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: '',
             miner: '',
             parser: '',
@@ -887,6 +1300,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 0,
             status: 1,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840003,
+                hash: '00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119',
+                progress: {
+                    bucket_id: 4,
+                    num_utxos: 0,
+                    num_transactions: 0,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 0,
+                    parsed_vout: 0,
+                    parser: 'alice',
+                },
+            },
+        ])
     })
 
     it('parse 840003', async () => {
@@ -903,22 +1333,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 0,
             parsed_height: 840003,
             parsing_height: 840004,
-            parsing_progress_of: [
-                {
-                    first: '000000000000000000028458274b1f458d57d817fdce349e31dd5cb51b277d36',
-                    second: {
-                        bucket_id: 5,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'alice',
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: '',
             miner: '',
             parser: '',
@@ -926,6 +1341,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 0,
             status: 1,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840004,
+                hash: '000000000000000000028458274b1f458d57d817fdce349e31dd5cb51b277d36',
+                progress: {
+                    bucket_id: 5,
+                    num_utxos: 0,
+                    num_transactions: 0,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 0,
+                    parsed_vout: 0,
+                    parser: 'alice',
+                },
+            },
+        ])
     })
 
     it('parse 840004', async () => {
@@ -942,22 +1374,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 0,
             parsed_height: 840004,
             parsing_height: 840005,
-            parsing_progress_of: [
-                {
-                    first: '000000000000000000027b0ec0e3acadd018cd19e7dd976602f216a1bc12d079',
-                    second: {
-                        bucket_id: 6,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'alice',
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: '',
             miner: '',
             parser: '',
@@ -965,6 +1382,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 0,
             status: 1,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840005,
+                hash: '000000000000000000027b0ec0e3acadd018cd19e7dd976602f216a1bc12d079',
+                progress: {
+                    bucket_id: 6,
+                    num_utxos: 0,
+                    num_transactions: 0,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 0,
+                    parsed_vout: 0,
+                    parser: 'alice',
+                },
+            },
+        ])
     })
 
     it('parse 840005', async () => {
@@ -981,22 +1415,7 @@ describe('utxomng.xsat', () => {
             migrated_num_utxos: 0,
             parsed_height: 840005,
             parsing_height: 840006,
-            parsing_progress_of: [
-                {
-                    first: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
-                    second: {
-                        bucket_id: 7,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'alice',
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: 'bob',
             miner: 'bob',
             parser: 'bob',
@@ -1004,6 +1423,25 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 4,
             status: 1,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840006,
+                hash: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
+                progress: {
+                    bucket_id: 7,
+                    num_utxos: 1,
+                    num_transactions: 4837,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 1,
+                    parsed_vout: 1,
+                    parser: 'alice',
+                },
+            },
+        ])
+        // the speculative progress has been taken over
+        expect(contracts.utxomng.tables.specparsing().getTableRows()).toEqual([])
     })
 
     it('parse 840006: migrate utxo', async () => {
@@ -1025,22 +1463,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 11447,
             parsed_height: 840005,
             parsing_height: 840006,
-            parsing_progress_of: [
-                {
-                    first: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
-                    second: {
-                        bucket_id: 7,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'alice',
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: 'bob',
             miner: 'bob',
             parser: 'bob',
@@ -1048,6 +1471,23 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 4,
             status: 3,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840006,
+                hash: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
+                progress: {
+                    bucket_id: 7,
+                    num_utxos: 1,
+                    num_transactions: 4837,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 1,
+                    parsed_vout: 1,
+                    parser: 'alice',
+                },
+            },
+        ])
     })
 
     it('parse 840006: delete data', async () => {
@@ -1064,22 +1504,7 @@ describe('utxomng.xsat', () => {
             migrating_num_utxos: 11447,
             parsed_height: 840005,
             parsing_height: 840006,
-            parsing_progress_of: [
-                {
-                    first: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
-                    second: {
-                        bucket_id: 7,
-                        num_utxos: 0,
-                        num_transactions: 0,
-                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                        parsed_position: 0,
-                        parsed_transactions: 0,
-                        parsed_vin: 0,
-                        parsed_vout: 0,
-                        parser: 'alice',
-                    },
-                },
-            ],
+            parsing_progress_of: [],
             synchronizer: 'bob',
             miner: 'bob',
             parser: 'bob',
@@ -1087,6 +1512,41 @@ describe('utxomng.xsat', () => {
             num_provider_validators: 4,
             status: 4,
         })
+        expect(get_parsing_blocks()).toEqual([
+            {
+                height: 840006,
+                hash: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
+                progress: {
+                    bucket_id: 7,
+                    num_utxos: 1,
+                    num_transactions: 4837,
+                    parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                    parsed_position: 0,
+                    parsed_transactions: 0,
+                    parsed_vin: 1,
+                    parsed_vout: 1,
+                    parser: 'alice',
+                },
+            },
+        ])
+    })
+
+    it('parse 840006: block header is archived', async () => {
+        // 840000 opens the chunk of heights 840000 to 840015
+        expect(contracts.utxomng.tables.headers().getTableRows()).toEqual([
+            {
+                id: 52500,
+                start_height: 840000,
+                headers: expect.any(String),
+            },
+        ])
+        const [chunk] = contracts.utxomng.tables.headers().getTableRows()
+        expect(chunk.headers.length).toEqual(112 * 2)
+        expect(chunk.headers.substring(0, 64)).toEqual(
+            '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5'
+        )
+        expect(get_block(840000)).toEqual(undefined)
+        expect(get_consensus_block().find(block => block.height == 840000)).toEqual(undefined)
     })
 
     it('parse 840006: distribute rewards', async () => {
@@ -1103,22 +1563,7 @@ describe('utxomng.xsat', () => {
                 num_utxos: 6683,
                 parsed_height: 840005,
                 parsing_height: 840006,
-                parsing_progress_of: [
-                    {
-                        first: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
-                        second: {
-                            bucket_id: 7,
-                            num_utxos: 0,
-                            num_transactions: 0,
-                            parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                            parsed_position: 0,
-                            parsed_transactions: 0,
-                            parsed_vin: 0,
-                            parsed_vout: 0,
-                            parser: 'alice',
-                        },
-                    },
-                ],
+                parsing_progress_of: [],
                 synchronizer: '',
                 miner: '',
                 parser: '',
@@ -1126,6 +1571,113 @@ describe('utxomng.xsat', () => {
                 num_provider_validators: 0,
                 status: 5,
             })
+            expect(get_parsing_blocks()).toEqual([
+                {
+                    height: 840006,
+                    hash: '0000000000000000000098dab8c28e5f20ab1663b8dd6c81bb54bbbcd0ead5ac',
+                    progress: {
+                        bucket_id: 7,
+                        num_utxos: 1,
+                        num_transactions: 4837,
+                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                        parsed_position: 0,
+                        parsed_transactions: 0,
+                        parsed_vin: 1,
+                        parsed_vout: 1,
+                        parser: 'alice',
+                    },
+                },
+            ])
+    })
+
+    it('parse 840006: utxo set commitment is published', async () => {
+        expect(get_utxo_set().commitment).not.toEqual(
+            '0000000000000000000000000000000000000000000000000000000000000000'
+        )
+    })
+
+    it('utxosbyscrpt: pages follow next_cursor', async () => {
+        // the standard script locking the most utxos of 840000
+        const utxos_by_script = new Map()
+        for (const utxo of contracts.utxomng.tables.utxos().getTableRows()) {
+            utxos_by_script.set(utxo.scriptpubkey, [...(utxos_by_script.get(utxo.scriptpubkey) ?? []), utxo])
+        }
+        const [scriptpubkey, utxos] = [...utxos_by_script]
+            .filter(([scriptpubkey]) => !compress_script(scriptpubkey).startsWith('ff'))
+            .reduce((most, entry) => (entry[1].length > most[1].length ? entry : most))
+        expect(utxos.length).toBeGreaterThanOrEqual(3)
+
+        const pages = []
+        let cursor = 0
+        do {
+            await contracts.utxomng.actions.utxosbyscrpt([scriptpubkey, cursor, 2]).send('alice')
+            const page = decodeReturn_utxo_page(blockchain.actionTraces[0].returnValue)
+            expect(page.utxos.length).toBeLessThanOrEqual(2)
+            expect(page.cold_omitted).toEqual(false)
+            pages.push(page)
+            cursor = page.next_cursor
+        } while (cursor > 0 && pages.length <= utxos.length)
+        expect(pages.length).toEqual(Math.ceil(utxos.length / 2))
+        expect(pages.flatMap(page => page.utxos)).toEqual([...utxos].sort((a, b) => a.id - b.id))
+
+        // the same script is found by its address
+        await contracts.utxomng.actions.scripttoaddr([scriptpubkey]).send('utxomng.xsat@active')
+        const [address] = decodeReturn_scripttoaddr(blockchain.actionTraces[0].returnValue)
+        await contracts.utxomng.actions.utxosbyaddr([address, 0, 1000]).send('alice')
+        expect(decodeReturn_utxo_page(blockchain.actionTraces[0].returnValue)).toEqual({
+            utxos: [...utxos].sort((a, b) => a.id - b.id),
+            next_cursor: 0,
+            cold_omitted: false,
+        })
+        await contracts.utxomng.actions.getbalance([address]).send('alice')
+        expect(decodeReturn_getbalance(blockchain.actionTraces[0].returnValue)).toEqual({
+            id: expect.any(Number),
+            scripthash: sha256(Buffer.from(scriptpubkey, 'hex')).toString('hex'),
+            value: utxos.reduce((value, utxo) => value + utxo.value, 0),
+            num_utxos: utxos.length,
+        })
+    })
+
+    it('utxosbyaddr: addresses are decoded to their script', async () => {
+        const scripts = {
+            '18cBEMRxXHqzWWCxZNtU91F5sbUNKhL5PX': '76a914536ffa992491508dca0354e52f32a3a7a679a53a88ac',
+            bc1qte0s6pz7gsdlqq2cf6hv5mxcfksykyyyjkdfd5: '00145e5f0d045e441bf001584eaeca6cd84da04b1084',
+        }
+        for (const [address, scriptpubkey] of Object.entries(scripts)) {
+            await contracts.utxomng.actions.utxosbyaddr([address, 0, 1000]).send('alice')
+            const page = decodeReturn_utxo_page(blockchain.actionTraces[0].returnValue)
+            await contracts.utxomng.actions.utxosbyscrpt([scriptpubkey, 0, 1000]).send('alice')
+            expect(page).toEqual(decodeReturn_utxo_page(blockchain.actionTraces[0].returnValue))
+
+            await contracts.utxomng.actions.getbalance([address]).send('alice')
+            const balance = decodeReturn_getbalance(blockchain.actionTraces[0].returnValue)
+            expect(balance.scripthash).toEqual(sha256(Buffer.from(scriptpubkey, 'hex')).toString('hex'))
+            expect(balance.num_utxos).toEqual(page.utxos.length)
+        }
+    })
+
+    it('getoutpoints: at most 1000 outpoints per call', async () => {
+        const outpoint = { txid: '0000000000000000000000000000000000000000000000000000000000000001', index: 0 }
+        await expectToThrow(
+            contracts.utxomng.actions.getoutpoints([new Array(1001).fill(outpoint)]).send('alice'),
+            'eosio_assert: 4014:utxomng.xsat::getoutpoints: at most 1000 outpoints per call'
+        )
+    })
+
+    it('getoutpoints: unknown outpoints are omitted', async () => {
+        const utxos = contracts.utxomng.tables.utxos().getTableRows()
+        const [first, second] = [utxos[utxos.length - 1], utxos[0]]
+        await contracts.utxomng.actions
+            .getoutpoints([
+                [
+                    { txid: first.txid, index: first.index },
+                    { txid: first.txid, index: 9999 },
+                    { txid: second.txid, index: second.index },
+                    { txid: '0000000000000000000000000000000000000000000000000000000000000001', index: 0 },
+                ],
+            ])
+            .send('alice')
+        expect(decodeReturn_getoutpoints(blockchain.actionTraces[0].returnValue)).toEqual([first, second])
     })
 
     it('parse 840006: parse', async () => {
@@ -1141,22 +1693,7 @@ describe('utxomng.xsat', () => {
                 migrating_num_utxos: 11888,
                 parsed_height: 840006,
                 parsing_height: 840007,
-                parsing_progress_of: [
-                    {
-                        first: '000000000000000000030d1455700ec234e4214e75e8e1112632b74febe80c78',
-                        second: {
-                            bucket_id: 8,
-                            num_transactions: 0,
-                            num_utxos: 0,
-                            parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
-                            parsed_position: 0,
-                            parsed_transactions: 0,
-                            parsed_vin: 0,
-                            parsed_vout: 0,
-                            parser: 'alice',
-                        },
-                    },
-                ],
+                parsing_progress_of: [],
                 synchronizer: 'alice',
                 miner: '',
                 parser: 'bob',
@@ -1165,5 +1702,501 @@ describe('utxomng.xsat', () => {
                 num_provider_validators: 4,
                 status: 1,
             })
+            expect(get_parsing_blocks()).toEqual([
+                {
+                    height: 840007,
+                    hash: '000000000000000000030d1455700ec234e4214e75e8e1112632b74febe80c78',
+                    progress: {
+                        bucket_id: 8,
+                        num_transactions: 0,
+                        num_utxos: 0,
+                        parse_expiration_time: addTime(blockchain.timestamp, TimePointSec.from(10 * 60)).toString(),
+                        parsed_position: 0,
+                        parsed_transactions: 0,
+                        parsed_vin: 0,
+                        parsed_vout: 0,
+                        parser: 'alice',
+                    },
+                },
+            ])
+    })
+
+    it('setshardsize: missing required authority', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions.setshardsize([2500]).send('alice'),
+            'missing required authority utxomng.xsat'
+        )
+    })
+
+    it('parse 840007: split into shards', async () => {
+        await contracts.utxomng.actions.setshardsize([2500]).send('utxomng.xsat')
+        expect(get_config().num_txs_per_shard).toEqual(2500)
+
+        // the start positions of the shards are recorded over several calls
+        await contracts.utxomng.actions.parseblock(['alice', 100, get_nonce()]).send('alice@active')
+        expect(contracts.utxomng.tables.parsesplit(BigInt(8)).getTableRows()).toEqual([
+            {
+                num_transactions: 4864,
+                num_txs_per_shard: 2500,
+                split_transactions: 99,
+                split_position: 20312,
+            },
+        ])
+        expect(contracts.utxomng.tables.parseshards(BigInt(8)).getTableRows()).toEqual([
+            {
+                id: 0,
+                start_transaction: 0,
+                progress: {
+                    bucket_id: 8,
+                    num_utxos: 0,
+                    num_transactions: 2500,
+                    parse_expiration_time: '1970-01-01T00:00:00',
+                    parsed_position: 3,
+                    parsed_transactions: 0,
+                    parsed_vin: 0,
+                    parsed_vout: 0,
+                    parser: '',
+                },
+            },
+        ])
+
+        // the split completes and alice starts parsing the first shard
+        await contracts.utxomng.actions.parseblock(['alice', 3000, get_nonce()]).send('alice@active')
+        expect(contracts.utxomng.tables.parsesplit(BigInt(8)).getTableRows()).toEqual([])
+        const shards = contracts.utxomng.tables.parseshards(BigInt(8)).getTableRows()
+        expect(shards.map(shard => [shard.id, shard.start_transaction, shard.progress.parser])).toEqual([
+            [0, 0, 'alice'],
+            [1, 2500, ''],
+        ])
+        expect(shards[0].progress.parsed_transactions).toBeLessThan(2500)
+        expect(shards[1].progress).toEqual({
+            bucket_id: 8,
+            num_utxos: 0,
+            num_transactions: 2364,
+            parse_expiration_time: '1970-01-01T00:00:00',
+            parsed_position: 717259,
+            parsed_transactions: 0,
+            parsed_vin: 0,
+            parsed_vout: 0,
+            parser: '',
+        })
+
+        // the block progress only accumulates the shard progress
+        const [parsing_block] = get_parsing_blocks()
+        expect(parsing_block.progress.parser).toEqual('')
+        expect(parsing_block.progress.num_transactions).toEqual(4864)
+        expect(parsing_block.progress.parsed_transactions).toEqual(shards[0].progress.parsed_transactions)
+        expect(parsing_block.progress.num_utxos).toEqual(shards[0].progress.num_utxos)
+    })
+
+    it('parse 840007: shards are parsed by different synchronizers', async () => {
+        // bob skips the shard held by alice
+        await contracts.utxomng.actions.parseblock(['bob', 0, get_nonce()]).send('bob@active')
+        const shards = contracts.utxomng.tables.parseshards(BigInt(8)).getTableRows()
+        expect(shards.map(shard => [shard.id, shard.progress.parser])).toEqual([[0, 'alice']])
+        expect(get_parsing_blocks()[0].progress.parsed_transactions).toEqual(
+            shards[0].progress.parsed_transactions + 2364
+        )
+
+        await contracts.utxomng.actions.parseblock(['alice', 0, get_nonce()]).send('alice@active')
+        expect(contracts.utxomng.tables.parseshards(BigInt(8)).getTableRows()).toEqual([])
+        expect(get_parsing_blocks()).toEqual([])
+
+        // the sharded parse saves the same utxos as a sequential one
+        const consensus_block = get_consensus_block(8)
+        expect(consensus_block.parse).toEqual(true)
+        expect(consensus_block.parser).toEqual('alice')
+        expect(consensus_block.num_utxos).toEqual(17458)
+        expect(get_chain_state().parsed_height).toEqual(840007)
+        expect(get_chain_state().parsing_height).toEqual(0)
+    })
+
+    it('migrate 840001: spent utxos are logged in the height scope', async () => {
+        const utxos = contracts.utxomng.tables.utxos().getTableRows()
+        expect(get_chain_state().migrating_height).toEqual(840001)
+        await contracts.utxomng.actions.processblock(['alice', 0, get_nonce()]).send('alice@active')
+        expect(get_chain_state().status).toEqual(3)
+
+        const unspent = new Set(contracts.utxomng.tables.utxos().getTableRows().map(utxo => utxo.id))
+        const spent_utxos = utxos.filter(utxo => !unspent.has(utxo.id))
+        expect(spent_utxos.length).toBeGreaterThan(0)
+
+        // one compressed row per spent utxo, outputs created and spent within 840001 are logged as well
+        const outpoint_key = ({ txid, index }) => `${txid}:${index}`
+        const spent_logs = contracts.utxomng.tables.spentlog(BigInt(840001)).getTableRows()
+        const spent_log_map = new Map(spent_logs.map(row => [outpoint_key(row), row]))
+        expect(spent_log_map.size).toEqual(spent_logs.length)
+        expect(spent_logs.length).toBeGreaterThanOrEqual(spent_utxos.length)
+        for (const utxo of spent_utxos) {
+            expect(spent_log_map.get(outpoint_key(utxo))).toEqual({
+                id: expect.any(Number),
+                txid: utxo.txid,
+                index: utxo.index,
+                script: compress_script(utxo.scriptpubkey),
+                value: utxo.value,
+            })
+        }
+        expect(contracts.utxomng.tables.spentutxos().getTableRows()).toEqual([])
+    })
+
+    it('migrate 840001: expired spent log scopes are reclaimed', async () => {
+        expect(contracts.utxomng.tables.spentstate().getTableRows()).toEqual([{ pruned_height: 835000 }])
+        expect(contracts.utxomng.tables.spentlog(BigInt(840000)).getTableRows().length).toBeGreaterThan(0)
+
+        // without retention the logs up to the migrating block expire
+        await contracts.utxomng.actions.config([600, 100, 0, 100, 11, 0]).send('utxomng.xsat')
+        await contracts.utxomng.actions.processblock(['alice', 0, get_nonce()]).send('alice@active')
+        expect(get_chain_state().status).toEqual(4)
+        expect(contracts.utxomng.tables.spentlog(BigInt(840000)).getTableRows()).toEqual([])
+        expect(contracts.utxomng.tables.spentlog(BigInt(840001)).getTableRows()).toEqual([])
+        expect(contracts.utxomng.tables.spentstate().getTableRows()).toEqual([{ pruned_height: 840001 }])
+
+        await contracts.utxomng.actions.config([600, 100, 5000, 100, 11, 0]).send('utxomng.xsat')
+    })
+
+    let frozen_utxos = []
+    it('migrate 840001: dormant utxos are frozen', async () => {
+        const utxos = contracts.utxomng.tables.utxos().getTableRows()
+
+        // only the newest utxo stays in utxos
+        await contracts.utxomng.actions.setcoldtier([1, 100000]).send('utxomng.xsat')
+        let max_times = 100
+        while (max_times-- && get_chain_state().irreversible_height < 840001) {
+            await contracts.utxomng.actions.processblock(['alice', 0, get_nonce()]).send('alice@active')
+        }
+        expect(get_chain_state().irreversible_height).toEqual(840001)
+
+        const hot_utxos = contracts.utxomng.tables.utxos().getTableRows()
+        const cold_utxos = get_cold_utxos()
+        expect(hot_utxos.length).toEqual(1)
+        expect(cold_utxos.length).toEqual(get_chain_state().num_utxos - 1)
+        expect(cold_utxos.every(utxo => utxo.id < hot_utxos[0].id)).toEqual(true)
+        expect(contracts.utxomng.tables.coldtier().getTableRows()[0]).toEqual({
+            retained_hot_utxos: 1,
+            max_frozen_utxos: 100000,
+            frozen_id: Math.max(...cold_utxos.map(utxo => utxo.id)) + 1,
+        })
+
+        // utxos are bucketed by the first 24 bits of the txid
+        for (const { bucket, utxos } of contracts.utxomng.tables.coldutxos().getTableRows()) {
+            expect(utxos.every(utxo => parseInt(utxo.txid.substring(0, 6), 16) == bucket)).toEqual(true)
+        }
+
+        // a frozen utxo is unpacked to the row it was moved from
+        const utxo_by_id = new Map(utxos.map(utxo => [utxo.id, utxo]))
+        const moved_utxos = cold_utxos.filter(utxo => utxo_by_id.has(utxo.id))
+        expect(moved_utxos.length).toBeGreaterThan(0)
+        expect(moved_utxos).toEqual(moved_utxos.map(utxo => utxo_by_id.get(utxo.id)))
+
+        // frozen utxos keep their balance and stay in the utxo set hash
+        expect_utxo_set(hot_utxos, cold_utxos)
+
+        // getoutpoints finds frozen and hot utxos alike
+        const [cold_utxo] = moved_utxos
+        await contracts.utxomng.actions
+            .getoutpoints([
+                [
+                    { txid: cold_utxo.txid, index: cold_utxo.index },
+                    { txid: '0000000000000000000000000000000000000000000000000000000000000001', index: 0 },
+                    { txid: hot_utxos[0].txid, index: hot_utxos[0].index },
+                ],
+            ])
+            .send('alice')
+        expect(decodeReturn_getoutpoints(blockchain.actionTraces[0].returnValue)).toEqual([
+            utxo_by_id.get(cold_utxo.id),
+            hot_utxos[0],
+        ])
+
+        // frozen utxos are not listed by script
+        await contracts.utxomng.actions.utxosbyscrpt([cold_utxo.scriptpubkey, 0, 1000]).send('alice')
+        expect(decodeReturn_utxo_page(blockchain.actionTraces[0].returnValue)).toEqual({
+            utxos: hot_utxos.filter(utxo => utxo.scriptpubkey == cold_utxo.scriptpubkey),
+            next_cursor: 0,
+            cold_omitted: true,
+        })
+
+        frozen_utxos = cold_utxos
+    })
+
+    it('migrate 840001: pipeline timeline and stats', async () => {
+        const unreached = '1970-01-01T00:00:00'
+        const timelines = contracts.utxomng.tables.timelines().getTableRows()
+        const timeline = timelines.find(
+            row => row.hash == '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463'
+        )
+        expect(timeline.height).toEqual(840001)
+        expect(timeline.num_rows).toEqual(11888)
+
+        // bucket init, upload, verify pass, btc quorum, parse start and end, migration and irreversible; XSAT
+        // consensus is not active yet
+        const stage_times = [0, 1, 2, 3, 5, 6, 7, 8].map(stage => timeline.stage_times[stage])
+        expect(stage_times).not.toContain(unreached)
+        expect(stage_times).toEqual([...stage_times].sort())
+        expect(timeline.stage_times[4]).toEqual(unreached)
+
+        // each block is sampled once per stage, repeated reports only count as calls
+        const pipeline_stats = contracts.utxomng.tables.pipestats().getTableRows()[0]
+        expect(pipeline_stats.stages.length).toEqual(9)
+        pipeline_stats.stages.forEach((metric, stage) => {
+            expect(metric.samples).toEqual(timelines.filter(row => row.stage_times[stage] != unreached).length)
+            expect(metric.calls).toBeGreaterThanOrEqual(metric.samples)
+        })
+        expect(pipeline_stats.stages[7]).toMatchObject({ calls: 2, samples: 2 })
+        expect(pipeline_stats.stages[8]).toMatchObject({ calls: 2, samples: 2 })
+
+        // 840000 took 1200 seconds from migration to irreversible
+        expect(pipeline_stats.stages[8].avg_seconds).toBeGreaterThan(0)
+
+        // 840000 and 840001 migrated 11447 and 11888 rows
+        expect(pipeline_stats.num_blocks).toEqual(2)
+        expect(pipeline_stats.avg_rows_per_block).toEqual(Math.floor((11447 * 15 + 11888) / 16))
+    })
+
+    it('migrate 840001: block header is appended to the chunk', async () => {
+        expect(get_chain_state().irreversible_height).toEqual(840001)
+
+        const chunks = contracts.utxomng.tables.headers().getTableRows()
+        expect(chunks.length).toEqual(1)
+        expect(chunks[0].id).toEqual(52500)
+        expect(chunks[0].start_height).toEqual(840000)
+        expect(chunks[0].headers.length).toEqual(2 * 112 * 2)
+        expect(chunks[0].headers.substring(0, 64)).toEqual(
+            '0000000000000000000320283a032748cef8227873ff4872689bf23f1cda83a5'
+        )
+        expect(chunks[0].headers.substring(112 * 2, 112 * 2 + 64)).toEqual(
+            '00000000000000000001b48a75d5a3077913f3f441eb7e08c13c43f768db2463'
+        )
+        expect(get_block(840001)).toEqual(undefined)
+    })
+
+    it('forkprune: losing forks are pruned', async () => {
+        const fork_hash = '00000000000000000000000000000000000000000000000000000000000000f2'
+        const add_fork_block = (bucket_id, height, hash, previous_block_hash) =>
+            contracts.utxomng.actions
+                .addconsesblk([
+                    bucket_id,
+                    height,
+                    hash,
+                    '0000000000000000000000000000000000000000753b8c1eaae701e1f0146360',
+                    671088644,
+                    previous_block_hash,
+                    '5cdb277afa34ea35aa620e5cad205f18acda80b80dec9dacf4b84636a5ad0448',
+                    1713571533,
+                    386089497,
+                    0,
+                    'alice',
+                    '',
+                    blockchain.timestamp.toString(),
+                ])
+                .send('utxomng.xsat@active')
+
+        // a sibling of the migrating block and a child on top of it
+        expect(get_chain_state().migrating_height).toEqual(840002)
+        await add_fork_block(
+            100,
+            840002,
+            fork_hash,
+            '00000000000000000000000000000000000000000000000000000000000000f1'
+        )
+        await add_fork_block(
+            101,
+            840003,
+            '00000000000000000000000000000000000000000000000000000000000000f3',
+            fork_hash
+        )
+
+        await contracts.utxomng.actions.processblock(['alice', 0, get_nonce()]).send('alice@active')
+        expect(get_consensus_block(100)).toEqual(undefined)
+        expect(get_consensus_block(101)).toEqual(undefined)
+        expect(get_consensus_block(3).hash).toEqual('00000000000000000002c0cc73626b56fb3ee1ce605b0ce125cc4fb58775a0a9')
+        expect(get_consensus_block(4).height).toEqual(840003)
+        expect(contracts.utxomng.tables.forkprune().getTableRows()[0].pruned_height).toEqual(840002)
+    })
+
+    it('migrate 840002: frozen utxos are unpacked when they are spent', async () => {
+        // forkprune has migrated 840002
+        expect(get_chain_state().migrating_height).toEqual(840002)
+        expect(get_chain_state().status).toEqual(3)
+
+        const hot_utxos = contracts.utxomng.tables.utxos().getTableRows()
+        const cold_utxos = get_cold_utxos()
+        expect(hot_utxos.length + cold_utxos.length).toEqual(get_chain_state().num_utxos)
+
+        const outpoint_key = ({ txid, index }) => `${txid}:${index}`
+        const unspent = new Set([...hot_utxos, ...cold_utxos].map(outpoint_key))
+        const spent_utxos = frozen_utxos.filter(utxo => !unspent.has(outpoint_key(utxo)))
+        expect(spent_utxos.length).toBeGreaterThan(0)
+
+        // the spends are logged with the script compressed again
+        const spent_logs = new Map(
+            contracts.utxomng.tables
+                .spentlog(BigInt(840002))
+                .getTableRows()
+                .map(row => [outpoint_key(row), row])
+        )
+        for (const utxo of spent_utxos) {
+            expect(spent_logs.get(outpoint_key(utxo))).toEqual({
+                id: expect.any(Number),
+                txid: utxo.txid,
+                index: utxo.index,
+                script: compress_script(utxo.scriptpubkey),
+                value: utxo.value,
+            })
+        }
+
+        // spent utxos are gone from both tiers
+        await contracts.utxomng.actions
+            .getoutpoints([spent_utxos.slice(0, 10).map(({ txid, index }) => ({ txid, index }))])
+            .send('alice')
+        expect(decodeReturn_getoutpoints(blockchain.actionTraces[0].returnValue)).toEqual([])
+
+        // their value is taken out of the balances and the utxo set hash
+        expect_utxo_set(hot_utxos, cold_utxos)
+    })
+
+    it('gettxproof: the block data is not retained', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .gettxproof([850000, 'dbfdf5cb081534b30ce7a5449543bbdab89197c89369c51d946053d92d142dfd'])
+                .send('alice'),
+            'eosio_assert: 4015:utxomng.xsat::gettxproof: the block data is not retained'
+        )
+    })
+
+    it('gettxproof: transaction does not exist in the block', async () => {
+        await expectToThrow(
+            contracts.utxomng.actions
+                .gettxproof([840003, '0000000000000000000000000000000000000000000000000000000000000001'])
+                .send('alice'),
+            'eosio_assert: 4016:utxomng.xsat::gettxproof: transaction does not exist in the block'
+        )
+    })
+
+    it('gettxproof', async () => {
+        // 840003 has reached consensus but is not irreversible yet
+        await contracts.utxomng.actions
+            .gettxproof([840003, 'dbfdf5cb081534b30ce7a5449543bbdab89197c89369c51d946053d92d142dfd'])
+            .send('alice')
+        expect(decodeReturn_gettxproof(blockchain.actionTraces[0].returnValue)).toEqual({
+            block_hash: '00000000000000000001cfe8671cb9269dfeded2c4e900e365fffae09b34b119',
+            merkle: '2daee999cac85a7663bbc3a0e24bd7c86e009c005e7d801ef104d134b420179b',
+            index: 5,
+            raw_transaction:
+                '02000000000101c4d7e5510509a2e831fc631301bab3c5fd6fb08982d2825bc9b445240ce5571a0100000000ffffffff030000000000000000096a5d0614c0a23314194a01000000000000225120fde331f7b7ba4b0705f1c70563fc1c1193339ea0bc857e90e0534be20b14c71c31fe66000000000017a914582cbbffe57fe55eae19197363ee9a636b8c21b1870140768c3a6873f44b63891f1b29d858f7205d6db458cb3196ea8b35da2c16263c8d8848203c484c16a0b32c9d1299493c1474b29ede58604d84c95133272c47c2f400000000',
+            branch: [
+                '1a57e50c2445b4c95b82d28289b06ffdc5b3ba011363fc31e8a2090551e5d7c4',
+                '7756423390225489fa349d4958ba1b8d32e769cd35c2b36d582a9417def87142',
+                '73a52583a4980e092ba56fa447e41bd05867690d05111bde70aec8ece2716f74',
+                'fc84f464b4e6af66e2610ca6ff4e739d1b7d00760c7a87cac08e66471c4e9919',
+                'f45c8247be492dc0dbcf11857e38f63509361da5039d32ffb47ef84571e63a2b',
+                '38732f81c7be559ed7ce64e56202c5dcde52227e567b246b021cc51ea4423a62',
+                '694921e87d7ce362fdb23a5f66b18bb77d8de826c0190e195437c80afc9f75cd',
+                'a2217e7b7162aaaa659d4a4ede577dbb6037dc25953017cb26222e7102b025bc',
+                '3200b190ca4b60b972a004c3591ee3b0e78c524665414dae2558e4efc8f77d94',
+                '1acb27ede6db27c373290828c35eda226a2a603d4470b2584329e6c4a9d212c1',
+                '2a18232bae23122421a38248537fd0028e648d05b25ad5b0971d6586994a5e48',
+                '7f0f53262fbfc958dff18d2f0230ec65bfcc66dd578810c7179d3647c87e5a71',
+                '8b09395a3df9eaad6f17b237b1bc2f81b3b8c83e95a0673e49b0edfa8177a550',
+            ],
+        })
+    })
+
+    it('custody verifyspv: the block is not irreversible', async () => {
+        expect(get_chain_state().irreversible_height).toEqual(840001)
+        await expectToThrow(
+            contracts.custody.actions.verifyspv(['alice', [spv_proof]]).send('alice@active'),
+            'eosio_assert: custody.xsat::verifyspv: the block is not irreversible'
+        )
+    })
+
+    it('collect garbage: reward logs and distributions are deleted within the caps', async () => {
+        const get_reward_log_heights = () =>
+            contracts.rwddist.tables
+                .rewardlogs()
+                .getTableRows()
+                .map(row => row.height)
+        const get_distribution_heights = () =>
+            contracts.gasfund.tables
+                .distributes()
+                .getTableRows()
+                .map(row => row.start_height)
+        const get_gc_state = () => contracts.utxomng.tables.gcstate().getTableRows()[0]
+
+        // gasfund has settled the fees of 840002, and evm fees up to 840010
+        await contracts.gasfund.actions.setfeestat([840002, 840010]).send('gasfund.xsat@active')
+        for (const start_height of [839990, 839995, 840000, 840005]) {
+            await contracts.gasfund.actions.adddistribut([start_height, start_height + 4]).send('gasfund.xsat@active')
+        }
+        expect(get_reward_log_heights()).toEqual(expect.arrayContaining([840000, 840001, 840002]))
+
+        // deleting the reward logs of a height costs two rows, which uses up max_rows
+        await contracts.utxomng.actions.setgcconfig([1, 1, 5, 2]).send('utxomng.xsat')
+        await contracts.utxomng.actions.processblock(['alice', 0, get_nonce()]).send('alice@active')
+        expect(get_chain_state().irreversible_height).toEqual(840001)
+        expect(get_reward_log_heights()).not.toContain(840000)
+        expect(get_reward_log_heights()).toEqual(expect.arrayContaining([840001, 840002]))
+        expect(get_distribution_heights()).toEqual([839990, 839995, 840000, 840005])
+        expect(get_gc_state()).toEqual({
+            spent_utxo_height: 835001,
+            block_data_height: 839901,
+            reward_log_height: 840000,
+            distribution_height: 0,
+            backlog: 840000,
+        })
+
+        // with rows to spare, max_actions stops the distributions after one
+        await contracts.utxomng.actions.setgcconfig([1, 1, 2, 100]).send('utxomng.xsat')
+        await contracts.utxomng.actions.processblock(['alice', 0, get_nonce()]).send('alice@active')
+        expect(get_chain_state().irreversible_height).toEqual(840002)
+        expect(get_reward_log_heights()).not.toContain(840001)
+        expect(get_reward_log_heights()).toContain(840002)
+        expect(get_distribution_heights()).toEqual([839995, 840000, 840005])
+        expect(get_gc_state()).toEqual({
+            spent_utxo_height: 835002,
+            block_data_height: 839902,
+            reward_log_height: 840001,
+            distribution_height: 839990,
+            backlog: 11,
+        })
+    })
+
+    it('custody verifyspv: merkle branch does not match the block header', async () => {
+        expect(get_chain_state().irreversible_height).toEqual(840002)
+
+        const tampered_branch = [...spv_proof.branch]
+        tampered_branch[0] = tampered_branch[1]
+        await expectToThrow(
+            contracts.custody.actions
+                .verifyspv(['alice', [{ ...spv_proof, branch: tampered_branch }]])
+                .send('alice@active'),
+            'eosio_assert: custody.xsat::verifyspv: merkle branch does not match the block header'
+        )
+        await expectToThrow(
+            contracts.custody.actions.verifyspv(['alice', [{ ...spv_proof, index: 56 }]]).send('alice@active'),
+            'eosio_assert: custody.xsat::verifyspv: merkle branch does not match the block header'
+        )
+    })
+
+    it('custody verifyspv', async () => {
+        // the proof served by gettxproof for the archived block is accepted as is
+        await contracts.utxomng.actions.gettxproof([840002, spv_proof_txid]).send('alice')
+        const { index, raw_transaction, branch } = decodeReturn_gettxproof(blockchain.actionTraces[0].returnValue)
+        expect({ index, raw_transaction, branch }).toEqual({
+            index: spv_proof.index,
+            raw_transaction: spv_proof.raw_transaction,
+            branch: spv_proof.branch,
+        })
+
+        await contracts.custody.actions.verifyspv(['alice', [spv_proof]]).send('alice@active')
+        const enrollment = contracts.custody.tables.enrollments().getTableRow(BigInt(Name.from('amy').value.value))
+        expect(enrollment.is_valid).toEqual(1)
+        expect(enrollment.txid).toEqual(spv_proof_txid)
+        expect(enrollment.index).toEqual(1)
+        expect(enrollment.verification_result).toEqual('spv verified by alice')
+
+        await expectToThrow(
+            contracts.custody.actions.verifyspv(['alice', [spv_proof]]).send('alice@active'),
+            'eosio_assert: custody.xsat::verifyspv: account verification already completed'
+        )
     })
 })